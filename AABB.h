@@ -1,5 +1,6 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <cmath>
 #include <vector> 
 
 
@@ -20,6 +21,47 @@ public:
         return distance < (radius1 + radius2);
     }
 
+    // 移動中的兩球（各自從 start 線性移到 end）第一次接觸的時間
+    // 在 [0, 1] 內接觸則回傳 true 並寫入 t；一開始就重疊且正在靠近時 t = 0，
+    // 一開始就重疊但正在分開（或沒有相對移動）時不算接觸
+    static bool SweptSphereToSphere(const glm::vec3& start1, const glm::vec3& end1, float radius1,
+                                    const glm::vec3& start2, const glm::vec3& end2, float radius2, float& t) {
+        // 以球 1 為參考：相對位置 d + v * t，解 |d + v t| = r1 + r2
+        glm::vec3 d = start2 - start1;
+        glm::vec3 v = (end2 - start2) - (end1 - start1);
+        float radiusSum = radius1 + radius2;
+        float c = glm::dot(d, d) - radiusSum * radiusSum;
+        float a = glm::dot(v, v);
+        float b = glm::dot(d, v);
+        if (c < 0.0f && b < 0.0f) {
+            t = 0.0f;
+            return true;
+        }
+        if (c < 0.0f || a < 1e-12f || b >= 0.0f) {
+            return false; // 沒有相對移動，或正在遠離
+        }
+        float discriminant = b * b - a * c;
+        if (discriminant < 0.0f) {
+            return false;
+        }
+        t = (-b - std::sqrt(discriminant)) / a;
+        return t <= 1.0f;
+    }
+
+    // 球在盒內沿一軸移動時撞牆的鏡射：超出 [lo, hi] 的距離反射回來並反轉速度。
+    // 只逐軸處理這一步的終點，不是球對盒的掃掠測試：單一軸上等同在撞牆時間點
+    // 反彈後走完剩下的時間，但不求撞牆時間，也不管其他軸。一步走超過整個房間寬度時夾回範圍內
+    static void ReflectInside(float& position, float& velocity, float lo, float hi) {
+        if (position < lo) {
+            position = 2.0f * lo - position;
+            velocity = -velocity;
+        } else if (position > hi) {
+            position = 2.0f * hi - position;
+            velocity = -velocity;
+        }
+        position = glm::clamp(position, lo, hi);
+    }
+
     // 計算距離 AABB 最近的點
     glm::vec3 ClosestPoint(const glm::vec3& point) const {
         return glm::vec3(
@@ -0,0 +1,71 @@
+#include "AiScheduler.h"
+#include "BallWorld.h"
+#include "FrameArena.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Weight of the smoothed per-selection cost given to the newest tick
+const double kTimingSmoothing = 0.1;
+
+float DistanceXZ(float x0, float z0, float x1, float z1) {
+    float dx = x1 - x0;
+    float dz = z1 - z0;
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+} // namespace
+
+AiScheduler::AiScheduler()
+    : budget(0), focus(0.0f), dueCount(0), grantedCount(0), lastMs(0.0), selectionMs(0.0) {}
+
+void AiScheduler::SetBudget(int selectionsPerTick) {
+    budget = std::max(selectionsPerTick, 0);
+}
+
+size_t AiScheduler::Schedule(const BallWorld& world, const uint32_t* predatorIndices, const uint32_t* due,
+                             size_t count, uint8_t* granted, float deltaTime, FrameArena& frameArena) {
+    dueCount = count;
+    if (budget == 0 || count <= static_cast<size_t>(budget)) {
+        for (size_t k = 0; k < count; k++) {
+            granted[due[k]] = 1;
+        }
+        grantedCount = count;
+        return grantedCount;
+    }
+
+    float* priority = frameArena.Allocate<float>(count);
+    uint32_t* order = frameArena.Allocate<uint32_t>(count);
+    for (size_t k = 0; k < count; k++) {
+        uint32_t i = predatorIndices[due[k]];
+        float closest = DistanceXZ(world.posX[i], world.posZ[i], focus.x, focus.y);
+        int target = world.targetHandle[i] == BallWorld::kNullHandle ? -1 : world.IndexOf(world.targetHandle[i]);
+        if (target >= 0) {
+            closest = std::min(closest, DistanceXZ(world.posX[i], world.posZ[i], world.posX[target], world.posZ[target]));
+        }
+        float closeness = 1.0f - std::min(closest, kProximityRadius) / kProximityRadius;
+        float overdue = static_cast<float>(world.GetTick() - world.selectionDueTick[i]) * deltaTime;
+        priority[k] = overdue + kProximityBonus * closeness;
+        order[k] = static_cast<uint32_t>(k);
+    }
+
+    // Highest priority first, ties to the lower predator: a strict order, so
+    // the chosen set does not depend on how nth_element gets there
+    grantedCount = static_cast<size_t>(budget);
+    std::nth_element(order, order + grantedCount, order + count, [&](uint32_t a, uint32_t b) {
+        return priority[a] > priority[b] || (priority[a] == priority[b] && due[a] < due[b]);
+    });
+    for (size_t k = 0; k < grantedCount; k++) {
+        granted[due[order[k]]] = 1;
+    }
+    return grantedCount;
+}
+
+void AiScheduler::RecordTiming(double milliseconds) {
+    lastMs = milliseconds;
+    if (grantedCount > 0) {
+        double perSelection = milliseconds / grantedCount;
+        selectionMs = selectionMs == 0.0 ? perSelection : selectionMs + (perSelection - selectionMs) * kTimingSmoothing;
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+class BallWorld;
+class FrameArena;
+
+// Rations the expensive predator AI work, target selection (the FSM's
+// value / distance scan and the fuzzy rule scoring), across ticks.
+//
+// A predator whose selection timer has fired is due. With a budget of N
+// selections per tick, the N due predators with the highest priority select
+// this tick; the others keep chasing their current target and are still due
+// next tick. Priority is how long the selection has been overdue, plus a
+// bonus of up to kProximityBonus seconds for being close to the focus point
+// (the camera) or to its own target. The wait keeps growing while the bonus
+// is bounded, so the budget goes round the population and nobody starves.
+//
+// The budget counts selections, not milliseconds: a wall-clock budget would
+// make the world depend on machine speed and break replays and state hashes.
+// The measured cost per selection is reported so a budget can be picked in ms.
+class AiScheduler {
+public:
+    // Seconds of priority a predator right at the focus or its target gains
+    static constexpr float kProximityBonus = 0.5f;
+    // The bonus fades out linearly up to this distance
+    static constexpr float kProximityRadius = 8.0f;
+
+    AiScheduler();
+
+    // Selections per tick; 0 = unlimited, every due predator selects
+    void SetBudget(int selectionsPerTick);
+    int GetBudget() const { return budget; }
+    // XZ position proximity is measured from
+    void SetFocus(const glm::vec2& focusXZ) { focus = focusXZ; }
+    glm::vec2 GetFocus() const { return focus; }
+
+    // Sets granted[p] for the predators predatorIndices[p] that select this
+    // tick, out of due (offsets into predatorIndices, dueCount of them), and
+    // returns how many. granted must be zeroed; the order of due does not
+    // matter. deltaTime turns overdue ticks into seconds. Scratch comes from frameArena.
+    size_t Schedule(const BallWorld& world, const uint32_t* predatorIndices, const uint32_t* due, size_t dueCount,
+                    uint8_t* granted, float deltaTime, FrameArena& frameArena);
+    // Wall-clock time of the last tick's predator AI, for display only
+    void RecordTiming(double milliseconds);
+
+    // Last tick: predators due, granted a selection, and deferred to a later tick
+    size_t GetDueCount() const { return dueCount; }
+    size_t GetGrantedCount() const { return grantedCount; }
+    size_t GetDeferredCount() const { return dueCount - grantedCount; }
+    double GetLastMs() const { return lastMs; }
+    // Smoothed ms per selection (AI time over selections on ticks that had any)
+    double GetSelectionMs() const { return selectionMs; }
+
+private:
+    int budget;
+    glm::vec2 focus;
+    size_t dueCount;
+    size_t grantedCount;
+    double lastMs;
+    double selectionMs;
+};
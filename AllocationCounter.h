@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+// Counts global heap allocations. AllocationCounter.cpp replaces the global
+// operator new / delete, so only link it into tools that check allocations
+// (the headless runner); the app and the benchmarks keep the default ones.
+// Memory from malloc directly, or from the aligned operator new overloads,
+// is not counted.
+namespace AllocationCounter {
+    // operator new calls (all threads) since the program started
+    uint64_t GetCount();
+}
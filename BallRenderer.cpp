@@ -0,0 +1,81 @@
+#include "BallRenderer.h"
+#include <GL/glew.h>
+
+BallRenderer::BallRenderer()
+    : shader(nullptr), uniforms(), VAO(0), vertexCount(0), instanceVBO(0), instanceCount(0), instanceCapacity(0) {}
+
+BallRenderer::~BallRenderer() {}
+
+void BallRenderer::Release() {
+    if (instanceVBO != 0) {
+        glDeleteBuffers(1, &instanceVBO);
+        instanceVBO = 0;
+    }
+    instanceCount = 0;
+    instanceCapacity = 0;
+}
+
+void BallRenderer::Init(Shader* ballShader, unsigned int ballVAO, int ballVertexCount) {
+    shader = ballShader;
+    uniforms.isbox = shader->GetUniform("isbox");
+    uniforms.isRoom = shader->GetUniform("isRoom");
+    uniforms.isInstanced = shader->GetUniform("isInstanced");
+
+    VAO = ballVAO;
+    vertexCount = ballVertexCount;
+
+    glBindVertexArray(VAO);
+    glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+    // per-instance: position.xyz + scale, then colour
+    glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)0);
+    glEnableVertexAttribArray(10);
+    glVertexAttribDivisor(10, 1);
+    glVertexAttribPointer(11, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(4 * sizeof(float)));
+    glEnableVertexAttribArray(11);
+    glVertexAttribDivisor(11, 1);
+
+    glBindVertexArray(0);
+}
+
+void BallRenderer::Upload(const BallWorld& world, float alpha) {
+    instanceCount = world.Size();
+    instances.resize(instanceCount);
+    for (size_t i = 0; i < instanceCount; i++) {
+        InstanceData& instance = instances[i];
+        instance.x = world.prevPosX[i] + (world.posX[i] - world.prevPosX[i]) * alpha;
+        instance.y = world.prevPosY[i] + (world.posY[i] - world.prevPosY[i]) * alpha;
+        instance.z = world.prevPosZ[i] + (world.posZ[i] - world.prevPosZ[i]) * alpha;
+        instance.scale = world.radius[i];
+        instance.r = world.color[i].r;
+        instance.g = world.color[i].g;
+        instance.b = world.color[i].b;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instanceCount > instanceCapacity) {
+        instanceCapacity = instanceCount + instanceCount / 2;
+    }
+    // Re-specifying the storage orphans last frame's buffer, so the driver
+    // does not stall waiting for draws that still read it
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+    if (instanceCount > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instanceCount * sizeof(InstanceData), instances.data());
+    }
+}
+
+void BallRenderer::Draw() {
+    if (instanceCount == 0) {
+        return;
+    }
+
+    shader->use();
+
+    shader->SetBool(uniforms.isbox, false);
+    shader->SetBool(uniforms.isRoom, false);
+    shader->SetBool(uniforms.isInstanced, true);
+
+    glBindVertexArray(VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, static_cast<GLsizei>(instanceCount));
+}
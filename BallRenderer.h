@@ -0,0 +1,46 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+#include "BallWorld.h"
+#include "Shader.h"
+
+// Draws every ball with one glDrawArraysInstanced per viewport.
+// Upload packs position + scale and colour for all balls into an instance
+// buffer once per frame; Draw only sets the per-object uniforms.
+class BallRenderer {
+public:
+    BallRenderer();
+    ~BallRenderer();
+
+    // Attaches the instance attributes (locations 10 and 11) to the ball VAO
+    // and resolves the uniform handles used by Draw
+    void Init(Shader* ballShader, unsigned int ballVAO, int ballVertexCount);
+    // alpha blends prevPos (0) to pos (1), see FixedTimestep::GetAlpha
+    void Upload(const BallWorld& world, float alpha = 1.0f);
+    // Camera and lights come from SceneUniformBuffer, bind the view first
+    void Draw();
+    // Needs the GL context, call before glfwTerminate
+    void Release();
+
+    size_t GetInstanceCount() const { return instanceCount; }
+
+private:
+    struct InstanceData {
+        float x, y, z, scale; // location 10
+        float r, g, b;        // location 11
+    };
+
+    struct Uniforms {
+        UniformHandle isbox, isRoom, isInstanced;
+    };
+
+    Shader* shader;
+    Uniforms uniforms;
+    unsigned int VAO;
+    int vertexCount;
+    unsigned int instanceVBO;
+    size_t instanceCount;
+    size_t instanceCapacity;
+    std::vector<InstanceData> instances;
+};
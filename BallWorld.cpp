@@ -0,0 +1,391 @@
+#include "BallWorld.h"
+#include "DrawBall.h"
+#include "FrameArena.h"
+#include "Integration.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+BallWorld::BallWorld()
+    : capacity(0), sleepEnabled(true), threatCellSize(kThreatCellSize), tick(0), selectionTimersStale(false),
+      fuzzyReselectDeltaTime(0.0f), fuzzyReselectTicks(DrawBall::FuzzyReselectTicks(0.0f)) {}
+
+uint32_t BallWorld::AcquireSlot(uint32_t index) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        // Past kMaxSlots handles would alias kNullHandle; 1M balls is far beyond what we run
+        slot = static_cast<uint32_t>(slotIndex.size());
+        slotIndex.push_back(0);
+        slotGeneration.push_back(0);
+        selectionTimers.Resize(slotIndex.size());
+    }
+    slotIndex[slot] = index;
+    return (slotGeneration[slot] << kSlotBits) | slot;
+}
+
+void BallWorld::ReleaseSlot(uint32_t slot) {
+    // Invalidate every outstanding handle to this ball, then recycle the slot
+    slotGeneration[slot] = (slotGeneration[slot] + 1) & (0xFFFFFFFFu >> kSlotBits);
+    freeSlots.push_back(slot);
+    selectionTimers.Cancel(slot);
+}
+
+DrawBall BallWorld::Add(float r) {
+    return DrawBall(this, AddBatch(1, r));
+}
+
+size_t BallWorld::AddBatch(size_t count, float r) {
+    size_t first = Size();
+    size_t size = first + count;
+    if (size > capacity) {
+        Reserve(std::max(size, capacity + capacity / 2));
+    }
+
+    posX.resize(size, 0.0f);
+    posY.resize(size, 0.0f);
+    posZ.resize(size, 0.0f);
+    prevPosX.resize(size, 0.0f);
+    prevPosY.resize(size, 0.0f);
+    prevPosZ.resize(size, 0.0f);
+    velX.resize(size, 0.0f);
+    velY.resize(size, 0.0f);
+    velZ.resize(size, 0.0f);
+    radius.resize(size, r);
+    gravity.resize(size, -9.8f);
+    flags.resize(size, 0);
+    sleepTimer.resize(size, 0.0f);
+    point.resize(size, 0);
+    score.resize(size, 0);
+    fsmState.resize(size, FSMState::SelectTarget);
+    targetHandle.resize(size, kNullHandle);
+    selectionDueTick.resize(size, kNoSelectionDue);
+    predatorSpeed.resize(size, 5.0f);
+    color.resize(size, glm::vec3(0.93f, 0.16f, 0.16f));
+    handle.resize(size);
+    for (size_t i = first; i < size; i++) {
+        handle[i] = AcquireSlot(static_cast<uint32_t>(i));
+    }
+    return first;
+}
+
+DrawBall BallWorld::Ball(size_t index) {
+    return DrawBall(this, index);
+}
+
+void BallWorld::Clear() {
+    // Back to front, so a respawn pops the slots in their old order
+    for (size_t i = Size(); i-- > 0;) {
+        ReleaseSlot(handle[i] & kMaxSlots);
+    }
+    ForEachArray([](auto& values) { values.clear(); });
+}
+
+void BallWorld::Reset() {
+    Clear();
+    slotIndex.clear();
+    slotGeneration.clear();
+    freeSlots.clear();
+    tick = 0;
+    selectionTimers.Reset(tick);
+}
+
+void BallWorld::Reserve(size_t newCapacity) {
+    if (newCapacity <= capacity) {
+        return;
+    }
+    capacity = newCapacity;
+    ForEachArray([newCapacity](auto& values) { values.reserve(newCapacity); });
+    slotIndex.reserve(newCapacity);
+    slotGeneration.reserve(newCapacity);
+    freeSlots.reserve(newCapacity);
+    keep.reserve(newCapacity);
+    targetGrid.Reserve(newCapacity);
+    selectionTimers.Reserve(newCapacity);
+}
+
+void BallWorld::RemoveAt(size_t index) {
+    ReleaseSlot(handle[index] & kMaxSlots);
+
+    size_t last = Size() - 1;
+    if (index != last) {
+        slotIndex[handle[last] & kMaxSlots] = static_cast<uint32_t>(index);
+    }
+    ForEachArray([index](auto& values) {
+        values[index] = values.back();
+        values.pop_back();
+    });
+}
+
+void BallWorld::CompactMarked() {
+    keep.clear();
+    for (size_t i = 0; i < Size(); i++) {
+        if (flags[i] & kRemoved) {
+            ReleaseSlot(handle[i] & kMaxSlots);
+        } else {
+            keep.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    const std::vector<uint32_t>& survivors = keep;
+    ForEachArray([&survivors](auto& values) {
+        for (size_t k = 0; k < survivors.size(); k++) {
+            values[k] = values[survivors[k]];
+        }
+        values.resize(survivors.size());
+    });
+    for (size_t k = 0; k < Size(); k++) {
+        slotIndex[handle[k] & kMaxSlots] = static_cast<uint32_t>(k);
+    }
+}
+
+void BallWorld::RemoveMarked() {
+    size_t marked = 0;
+    for (size_t i = 0; i < Size(); i++) {
+        marked += (flags[i] & kRemoved) != 0;
+    }
+    if (marked * 8 > Size()) {
+        CompactMarked();
+        return;
+    }
+    // Back to front: the ball moved into a hole always comes from behind it,
+    // so it has already been checked
+    for (size_t i = Size(); i-- > 0;) {
+        if (flags[i] & kRemoved) {
+            RemoveAt(i);
+        }
+    }
+}
+
+void BallWorld::SetSleepEnabled(bool enabled) {
+    sleepEnabled = enabled;
+    if (!enabled) {
+        for (size_t i = 0; i < Size(); i++) {
+            WakeUp(i);
+        }
+    }
+}
+
+void BallWorld::SetTick(uint32_t newTick) {
+    tick = newTick;
+    selectionTimersStale = true;
+}
+
+void BallWorld::ScheduleTargetSelection(size_t index, uint32_t dueTick) {
+    selectionDueTick[index] = dueTick;
+    if (!selectionTimersStale) {
+        selectionTimers.Schedule(handle[index] & kMaxSlots, dueTick);
+    }
+}
+
+void BallWorld::RebuildSelectionTimers() {
+    selectionTimers.Resize(slotIndex.size());
+    selectionTimers.Reset(tick);
+    for (size_t i = 0; i < Size(); i++) {
+        if ((flags[i] & kPredator) && selectionDueTick[i] != kNoSelectionDue) {
+            selectionTimers.Schedule(handle[i] & kMaxSlots, selectionDueTick[i]);
+        }
+    }
+    selectionTimersStale = false;
+}
+
+void BallWorld::SetThreatCellSize(float size) {
+    threatCellSize = glm::clamp(size, kMinThreatCellSize, kMaxThreatCellSize);
+}
+
+size_t BallWorld::CountAsleep() const {
+    size_t asleep = 0;
+    for (size_t i = 0; i < Size(); i++) {
+        asleep += IsAsleep(i);
+    }
+    return asleep;
+}
+
+void BallWorld::StorePreviousPositions() {
+    prevPosX = posX;
+    prevPosY = posY;
+    prevPosZ = posZ;
+}
+
+// FNV-1a over the raw bytes of an array
+template <typename T>
+static uint64_t HashArray(const std::vector<T>& values, uint64_t hash) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values.data());
+    for (size_t i = 0; i < values.size() * sizeof(T); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t BallWorld::StateHash() const {
+    uint64_t hash = 14695981039346656037ull;
+    hash = HashArray(posX, hash);
+    hash = HashArray(posY, hash);
+    hash = HashArray(posZ, hash);
+    hash = HashArray(velX, hash);
+    hash = HashArray(velY, hash);
+    hash = HashArray(velZ, hash);
+    hash = HashArray(flags, hash);
+    hash = HashArray(score, hash);
+    hash = HashArray(targetHandle, hash);
+    hash = HashArray(handle, hash);
+    return hash;
+}
+
+void BallWorld::BuildTargetGrid(const AABB& roomAABB) {
+    targetGrid.Build(roomAABB, kTargetCellSize, posX.data(), posY.data(), posZ.data(), Size());
+}
+
+void BallWorld::Update(float deltaTime, const AABB& roomAABB, JobSystem& jobs, FrameArena& frameArena) {
+    size_t count = Size();
+    StorePreviousPositions();
+
+    uint32_t* predatorIndices = frameArena.Allocate<uint32_t>(count);
+    uint32_t* predatorOffset = frameArena.Allocate<uint32_t>(count); // only set for predators
+    size_t predatorCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (flags[i] & kPredator) {
+            predatorOffset[i] = static_cast<uint32_t>(predatorCount);
+            predatorIndices[predatorCount++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    auto isGrayPredator = [this](uint32_t i) {
+        glm::vec3 c = color[i];
+        return c.r > 0.4f && c.g > 0.4f && c.b > 0.4f;
+    };
+
+    // The selection timers that fire this tick give the predators whose
+    // selection is due; the scheduler grants as many as the budget allows.
+    // Only then is the target grid worth building; positions do not move
+    // until integration, so one build serves every predator.
+    if (selectionTimersStale) {
+        RebuildSelectionTimers();
+    }
+    // Counted once per step size, not on every selection
+    if (deltaTime != fuzzyReselectDeltaTime) {
+        fuzzyReselectDeltaTime = deltaTime;
+        fuzzyReselectTicks = DrawBall::FuzzyReselectTicks(deltaTime);
+    }
+    tick++;
+    uint32_t* due = frameArena.Allocate<uint32_t>(predatorCount);
+    uint8_t* selectionGranted = frameArena.Allocate<uint8_t>(predatorCount);
+    std::fill(selectionGranted, selectionGranted + predatorCount, uint8_t(0));
+    size_t dueCount = 0;
+    selectionTimers.Advance(tick, [&](uint32_t slot) {
+        uint32_t i = slotIndex[slot];
+        if (!(flags[i] & kPredator) || selectionDueTick[i] == kNoSelectionDue) return;
+        if (selectionDueTick[i] > tick || (flags[i] & kStationary)) {
+            // Not due after all, or asleep: look again then / next tick
+            selectionTimers.Schedule(slot, selectionDueTick[i]);
+            return;
+        }
+        due[dueCount++] = predatorOffset[i];
+    });
+    size_t granted = aiScheduler.Schedule(*this, predatorIndices, due, dueCount, selectionGranted, deltaTime,
+                                          frameArena);
+    if (granted > 0) {
+        BuildTargetGrid(roomAABB);
+    }
+    // Deferred predators stay due and are looked at again next tick
+    for (size_t k = 0; k < dueCount; k++) {
+        if (!selectionGranted[due[k]]) {
+            selectionTimers.Schedule(handle[predatorIndices[due[k]]] & kMaxSlots, tick + 1);
+        }
+    }
+
+    // Predator AI: one predator per job, each queries the shared grid. The
+    // AI moves a predator's selectionDueTick when it selects or loses its
+    // target; those predators are collected and their timers re-armed after,
+    // in whatever order the jobs found them: nothing downstream depends on
+    // the order timers fire in (AiScheduler orders the due list itself).
+    uint32_t* rescheduled = frameArena.Allocate<uint32_t>(predatorCount);
+    std::atomic<size_t> rescheduledCount(0);
+    auto aiStart = std::chrono::steady_clock::now();
+    jobs.ParallelFor(predatorCount, 1, [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; p++) {
+            uint32_t i = predatorIndices[p];
+            if (flags[i] & kStationary) continue;
+            uint32_t previousDue = selectionDueTick[i];
+            DrawBall predator(this, i);
+            if (isGrayPredator(i)) {
+                predator.UpdateFSM(deltaTime, selectionGranted[p] != 0);
+            } else {
+                predator.UpdateFuzzyLogic(deltaTime, selectionGranted[p] != 0);
+            }
+            if (selectionDueTick[i] != previousDue) {
+                rescheduled[rescheduledCount.fetch_add(1, std::memory_order_relaxed)] = i;
+            }
+        }
+    });
+    aiScheduler.RecordTiming(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - aiStart).count());
+    for (size_t k = 0, n = rescheduledCount.load(); k < n; k++) {
+        uint32_t i = rescheduled[k];
+        if (selectionDueTick[i] == kNoSelectionDue) {
+            selectionTimers.Cancel(handle[i] & kMaxSlots);
+        } else {
+            selectionTimers.Schedule(handle[i] & kMaxSlots, selectionDueTick[i]);
+        }
+    }
+
+    // Prey avoidance: the predators splat into the threat field once, then
+    // every prey samples it instead of scanning the predators. Sleeping prey
+    // sample it too, so a predator in range wakes them.
+    threatField.Configure(roomAABB, threatCellSize, kWakeRadius);
+    for (size_t p = 0; p < predatorCount; p++) {
+        uint32_t i = predatorIndices[p];
+        threatField.Splat(prevPosX[i], prevPosZ[i]);
+    }
+    jobs.ParallelFor(count, kJobGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (flags[i] & kPredator) continue;
+
+            ThreatField::Sample threat = threatField.SampleAt(prevPosX[i], prevPosZ[i]);
+            bool threatened = threat.threat > 0.0f;
+            glm::vec3 avoidanceForce(-3.0f * threat.gradient.x, 0.0f, -3.0f * threat.gradient.y);
+            if (flags[i] & kStationary) {
+                if (!threatened) continue;
+                WakeUp(i);
+            }
+            float baseSpeed = 0.0f;
+            if (point[i] == 15) baseSpeed = 4.0f;
+            else if (point[i] == 10) baseSpeed = 3.0f;
+            else if (point[i] == 5) baseSpeed = 2.0f;
+            if (glm::length(avoidanceForce) > 0.001f) {
+                velX[i] = glm::clamp(velX[i] + avoidanceForce.x * deltaTime, -baseSpeed, baseSpeed);
+                velZ[i] = glm::clamp(velZ[i] + avoidanceForce.z * deltaTime, -baseSpeed, baseSpeed);
+            } else {
+                velX[i] = glm::clamp(velX[i], -baseSpeed, baseSpeed);
+                velZ[i] = glm::clamp(velZ[i], -baseSpeed, baseSpeed);
+            }
+        }
+    });
+
+    // Integration and wall bounce, vectorised over the arrays (Integration.h),
+    // then the sleep test for the same chunk while it is still in cache
+    glm::vec3 roomMin = roomAABB.GetMin();
+    jobs.ParallelFor(count, kJobGrain, [&](size_t begin, size_t end) {
+        Integration::Integrate(*this, begin, end, deltaTime, roomAABB);
+        if (!sleepEnabled) return;
+        for (size_t i = begin; i < end; i++) {
+            if (flags[i] & (kStationary | kPredator)) continue;
+            float scale = radius[i];
+
+            // Sleep: a prey that sits on the floor and barely moves for
+            // kSleepDelay stops being integrated until something wakes it.
+            // The floor clamp leaves posY exactly on the floor, and velY
+            // only flickers by gravity * dt there, so XZ speed is the test.
+            bool resting = posY[i] - scale <= roomMin.y + 1e-4f &&
+                           velX[i] * velX[i] + velZ[i] * velZ[i] < kSleepSpeed * kSleepSpeed;
+            sleepTimer[i] = resting ? sleepTimer[i] + deltaTime : 0.0f;
+            if (sleepTimer[i] >= kSleepDelay) {
+                flags[i] |= kStationary;
+                velX[i] = 0.0f;
+                velY[i] = 0.0f;
+                velZ[i] = 0.0f;
+            }
+        }
+    });
+}
@@ -0,0 +1,230 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "AABB.h"
+#include "AiScheduler.h"
+#include "SpatialGrid.h"
+#include "ThreatField.h"
+#include "TimerWheel.h"
+
+// FSM States for Gray Predator
+enum class FSMState {
+    SelectTarget,
+    ChaseTarget
+};
+
+class DrawBall;
+class FrameArena;
+class JobSystem;
+
+// Generation-tagged reference to a ball: low kSlotBits bits are a slot in the
+// world's slot table, the rest is the slot's generation when the handle was made.
+// Removing a ball bumps its slot's generation, so old handles stop resolving
+// instead of pointing at whichever ball reuses the slot.
+typedef uint32_t BallHandle;
+
+// Structure-of-arrays storage for every ball in the scene.
+// Hot physics state lives in separate contiguous arrays so the per-tick loops
+// stream through memory; DrawBall is only a (world, index) view on top of it.
+// The arrays stay dense: removal moves the last ball into the hole, and the
+// slot table keeps handles pointing at the right index.
+class BallWorld {
+public:
+    static constexpr BallHandle kNullHandle = 0xFFFFFFFFu;
+    static constexpr int kSlotBits = 20;
+    static constexpr uint32_t kMaxSlots = (1u << kSlotBits) - 1; // the all-ones slot belongs to kNullHandle
+    // Balls per job chunk; smaller worlds run on the calling thread only
+    static constexpr size_t kJobGrain = 4096;
+    // Cell size of the grid the predators query for prey
+    static constexpr float kTargetCellSize = 1.0f;
+    // Prey resting on the floor slower than kSleepSpeed (XZ) for kSleepDelay
+    // seconds fall asleep; a predator within kWakeRadius wakes them again
+    static constexpr float kSleepSpeed = 0.05f;
+    static constexpr float kSleepDelay = 0.5f;
+    static constexpr float kWakeRadius = 2.0f; // same as the prey avoidance radius
+    // Node spacing of the threat field prey avoid predators by, and its limits
+    static constexpr float kThreatCellSize = 0.25f;
+    static constexpr float kMinThreatCellSize = 0.05f;
+    static constexpr float kMaxThreatCellSize = 1.0f;
+    // selectionDueTick of a predator with no selection pending (FSM chasing)
+    static constexpr uint32_t kNoSelectionDue = 0xFFFFFFFFu;
+
+    enum Flags : uint8_t {
+        kPredator   = 1 << 0,
+        kStationary = 1 << 1, // asleep: skipped by integration and by sleeping-vs-sleeping pairs
+        kRemoved    = 1 << 2, // eaten this tick, dropped by RemoveMarked
+    };
+
+    BallWorld();
+
+    size_t Size() const { return posX.size(); }
+    // Balls the arrays hold before they have to grow, see Reserve
+    size_t Capacity() const { return capacity; }
+    DrawBall Add(float radius);
+    // Appends count balls with default state in one resize per array and
+    // returns the index of the first; spawn code fills them in through Ball()
+    size_t AddBatch(size_t count, float radius);
+    DrawBall Ball(size_t index);
+    // Drops every ball at once: arrays are truncated (capacity kept) and all
+    // slots go back to the free list with a new generation
+    void Clear();
+    // Clear, and also forget the slot table: handles start over from slot 0,
+    // generation 0, and the tick from 0, exactly as in a new world. Old handles may then resolve to
+    // new balls, so this is only for restarting a run from scratch.
+    void Reset();
+    // Sizes the pool: every array and the slot table get room for capacity
+    // balls up front, so spawning and respawning never touch the heap
+    void Reserve(size_t capacity);
+
+    // Current index of the ball, or -1 if it has been removed. O(1).
+    // The index is checked against Size() too, so even a handle that names a
+    // free slot's generation (only a corrupt one can) never indexes past the arrays
+    int IndexOf(BallHandle ballHandle) const {
+        uint32_t slot = ballHandle & kMaxSlots;
+        if (slot >= slotIndex.size() || slotGeneration[slot] != (ballHandle >> kSlotBits) ||
+            slotIndex[slot] >= Size()) {
+            return -1;
+        }
+        return static_cast<int>(slotIndex[slot]);
+    }
+    bool IsAlive(BallHandle ballHandle) const { return IndexOf(ballHandle) >= 0; }
+
+    bool IsAsleep(size_t index) const { return (flags[index] & kStationary) != 0; }
+    void WakeUp(size_t index) {
+        flags[index] &= ~kStationary;
+        sleepTimer[index] = 0.0f;
+    }
+    // Turning sleep off wakes every ball
+    void SetSleepEnabled(bool enabled);
+    bool GetSleepEnabled() const { return sleepEnabled; }
+    size_t CountAsleep() const;
+    // Clamped to [kMinThreatCellSize, kMaxThreatCellSize]; takes effect next Update
+    void SetThreatCellSize(float size);
+    float GetThreatCellSize() const { return threatCellSize; }
+
+    void MarkRemoved(size_t index) { flags[index] |= kRemoved; }
+    bool IsMarkedRemoved(size_t index) const { return (flags[index] & kRemoved) != 0; }
+    // Swap-and-pop for a few marked balls: O(marked), but the survivors'
+    // order is not kept. When a large share is marked (respawning the prey)
+    // it compacts every array in one pass instead.
+    void RemoveMarked();
+
+    // Updates run so far; the AI clock selectionDueTick counts in. Setting it
+    // (restoring a snapshot) re-arms the selection timers from the arrays.
+    uint32_t GetTick() const { return tick; }
+    void SetTick(uint32_t newTick);
+    // DrawBall::FuzzyReselectTicks for the deltaTime of the current Update
+    uint32_t GetFuzzyReselectTicks() const { return fuzzyReselectTicks; }
+    // Makes the predator at index select a target in the Update of tick
+    // dueTick, or the next Update if that has passed. Outside Update only:
+    // spawning and AI resets; the AI itself reschedules through selectionDueTick.
+    void ScheduleTargetSelection(size_t index, uint32_t dueTick);
+
+    // Predator AI, prey avoidance, then gravity / integration / wall bounce.
+    // Snapshots pos into prevPos first; every phase reads other balls only from
+    // that snapshot and writes only its own slot, so the phases are split across
+    // the job system and the result is the same for any thread count.
+    // Per-tick lists come from frameArena; the caller resets it between ticks.
+    void Update(float deltaTime, const AABB& roomAABB, JobSystem& jobs, FrameArena& frameArena);
+
+    // Copies pos into prevPos. Update does it at the start of every step; call it
+    // after spawning / teleporting balls so they are not interpolated from stale data.
+    void StorePreviousPositions();
+
+    // FNV-1a over the simulated state (positions, velocities, flags, scores,
+    // targets, handles). Equal hashes mean two runs are bit-identical so far.
+    uint64_t StateHash() const;
+
+    // Every per-ball array, then the slot table (index, generation, free list),
+    // always in this order. Snapshots store exactly these arrays; loading one
+    // resizes each and copies its bytes back, so handles survive a round trip.
+    template <typename F>
+    void ForEachStateArray(F&& f) {
+        selectionTimersStale = true; // the arrays may be overwritten, selectionDueTick with them
+        ForEachArray(f);
+        f(slotIndex); f(slotGeneration); f(freeSlots);
+    }
+    template <typename F>
+    void ForEachStateArray(F&& f) const {
+        const_cast<BallWorld*>(this)->ForEachArray([&f](auto& values) { f(std::as_const(values)); });
+        f(slotIndex); f(slotGeneration); f(freeSlots);
+    }
+
+    // All balls bucketed by position. Update rebuilds it on ticks where some
+    // predator picks a new target; selection then asks it for the prey within
+    // range instead of scanning the whole world.
+    void BuildTargetGrid(const AABB& roomAABB);
+    const SpatialGrid& GetTargetGrid() const { return targetGrid; }
+    // Predator threat over the floor, rebuilt by every Update from the
+    // predators' prevPos; prey avoidance samples it (radius kWakeRadius)
+    const ThreatField& GetThreatField() const { return threatField; }
+    // Decides which due predators select a target each Update, see AiScheduler
+    AiScheduler& GetAiScheduler() { return aiScheduler; }
+    const AiScheduler& GetAiScheduler() const { return aiScheduler; }
+    // One timer per predator (by slot) for its next target selection; Update
+    // only visits the predators whose timer fired instead of polling them all
+    const TimerWheel& GetSelectionTimers() const { return selectionTimers; }
+
+    // Hot: physics
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> prevPosX, prevPosY, prevPosZ; // state before the last step, for render interpolation
+    std::vector<float> velX, velY, velZ;
+    std::vector<float> radius;
+    std::vector<float> gravity;
+    std::vector<uint8_t> flags;
+    std::vector<float> sleepTimer; // seconds spent resting, see kSleepDelay
+
+    // Gameplay
+    std::vector<int> point; // 一般球的分數值
+    std::vector<int> score; // 掠食者的積分
+
+    // AI state (only meaningful for predators)
+    std::vector<FSMState> fsmState;
+    std::vector<BallHandle> targetHandle;
+    std::vector<uint32_t> selectionDueTick; // tick of the next target selection, or kNoSelectionDue
+    std::vector<float> predatorSpeed;
+
+    // Cold
+    std::vector<glm::vec3> color;
+    std::vector<BallHandle> handle;
+
+private:
+    // Calls f on every per-ball array, for the operations that treat them alike
+    template <typename F>
+    void ForEachArray(F&& f) {
+        f(posX); f(posY); f(posZ);
+        f(prevPosX); f(prevPosY); f(prevPosZ);
+        f(velX); f(velY); f(velZ);
+        f(radius); f(gravity); f(flags); f(sleepTimer);
+        f(point); f(score);
+        f(fsmState); f(targetHandle); f(selectionDueTick); f(predatorSpeed);
+        f(color); f(handle);
+    }
+    uint32_t AcquireSlot(uint32_t index);
+    void ReleaseSlot(uint32_t slot);
+    void RemoveAt(size_t index);
+    void CompactMarked();
+    // Re-arms every predator's timer from selectionDueTick
+    void RebuildSelectionTimers();
+
+    size_t capacity;
+    bool sleepEnabled;
+    float threatCellSize;
+    uint32_t tick;
+    bool selectionTimersStale;
+    float fuzzyReselectDeltaTime; // the step fuzzyReselectTicks was counted for
+    uint32_t fuzzyReselectTicks;
+    std::vector<uint32_t> keep; // scratch for CompactMarked
+
+    // Slot table: slot -> dense index, plus the generation live handles carry
+    std::vector<uint32_t> slotIndex;
+    std::vector<uint32_t> slotGeneration;
+    std::vector<uint32_t> freeSlots;
+    SpatialGrid targetGrid;
+    ThreatField threatField;
+    AiScheduler aiScheduler;
+    TimerWheel selectionTimers;
+};
@@ -0,0 +1,1436 @@
+// Offline benchmarks for the simulation hot paths (no window / GL context needed).
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "AABB.h"
+#include "AiScheduler.h"
+#include "BallWorld.h"
+#include "DrawBall.h"
+#include "FrameArena.h"
+#include "FuzzyEngine.h"
+#include "Integration.h"
+#include "SimdLevel.h"
+#include "JobSystem.h"
+#include "Narrowphase.h"
+#include "RewindBuffer.h"
+#include "Simulation.h"
+#include "SpatialGrid.h"
+#include "ThreatField.h"
+#include "TimerWheel.h"
+#include "WorldSnapshot.h"
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Same room as main.cpp
+const AABB kRoom(glm::vec3(7.2f - 10.0f, 6.3f - 10.0f, 4.8f - 10.0f), glm::vec3(7.2f, 6.3f, 4.8f));
+const float kBallRadius = 0.1f;
+
+double ElapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Scatter balls over the floor the same way InitializeBalls does
+void SpawnOnFloor(const AABB& room, size_t count, std::vector<float>& x, std::vector<float>& y, std::vector<float>& z) {
+    glm::vec3 roomMin = room.GetMin();
+    glm::vec3 roomMax = room.GetMax();
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        x[i] = roomMin.x + kBallRadius + (static_cast<float>(rand()) / RAND_MAX) * (roomMax.x - roomMin.x - 2.0f * kBallRadius);
+        z[i] = roomMin.z + kBallRadius + (static_cast<float>(rand()) / RAND_MAX) * (roomMax.z - roomMin.z - 2.0f * kBallRadius);
+        y[i] = roomMin.y + kBallRadius;
+    }
+}
+
+// Room with the same floor density as `balls` balls in `kRoom` would have at `referenceCount`
+AABB ScaledRoom(size_t balls, size_t referenceCount) {
+    float s = std::sqrt(static_cast<float>(balls) / referenceCount);
+    glm::vec3 roomMin = kRoom.GetMin();
+    glm::vec3 extent = kRoom.GetMax() - roomMin;
+    return AABB(roomMin, roomMin + glm::vec3(extent.x * s, extent.y, extent.z * s));
+}
+
+void BenchBroadphase(bool constantDensity) {
+    if (constantDensity) {
+        printf("== Broadphase: brute force vs uniform grid (room grows, density of 1k balls) ==\n");
+    } else {
+        printf("== Broadphase: brute force vs uniform grid (fixed room) ==\n");
+    }
+    printf("%8s | %14s %10s | %14s %10s %10s\n",
+           "balls", "brute pairs", "ms/frame", "grid pairs", "ms/frame", "contacts");
+
+    const size_t counts[] = { 100, 1000, 10000, 100000 };
+    const size_t kBruteForceLimit = 10000; // 100k brute force is ~5e9 tests per frame
+
+    for (size_t count : counts) {
+        AABB room = constantDensity ? ScaledRoom(count, 1000) : kRoom;
+        srand(1);
+        std::vector<float> x, y, z;
+        SpawnOnFloor(room, count, x, y, z);
+        int frames = count <= 1000 ? 100 : (count <= 10000 ? 10 : 3);
+
+        char bruteTested[32] = "-";
+        char bruteMs[32] = "skipped";
+        if (count <= kBruteForceLimit) {
+            size_t contacts = 0;
+            Clock::time_point start = Clock::now();
+            for (int f = 0; f < frames; f++) {
+                contacts = 0;
+                for (size_t i = 0; i < count; i++) {
+                    for (size_t j = i + 1; j < count; j++) {
+                        if (AABB::SphereToSphere(glm::vec3(x[i], y[i], z[i]), kBallRadius,
+                                                 glm::vec3(x[j], y[j], z[j]), kBallRadius)) {
+                            contacts++;
+                        }
+                    }
+                }
+            }
+            snprintf(bruteTested, sizeof(bruteTested), "%zu", count * (count - 1) / 2);
+            snprintf(bruteMs, sizeof(bruteMs), "%.3f", ElapsedMs(start) / frames);
+        }
+
+        SpatialGrid grid;
+        std::vector<SpatialGrid::Pair> pairs;
+        size_t contacts = 0;
+        Clock::time_point start = Clock::now();
+        for (int f = 0; f < frames; f++) {
+            grid.Build(room, 2.0f * kBallRadius, x.data(), y.data(), z.data(), count);
+            grid.FindPairs(pairs);
+            contacts = 0;
+            for (const auto& pair : pairs) {
+                if (AABB::SphereToSphere(glm::vec3(x[pair.a], y[pair.a], z[pair.a]), kBallRadius,
+                                         glm::vec3(x[pair.b], y[pair.b], z[pair.b]), kBallRadius)) {
+                    contacts++;
+                }
+            }
+        }
+        double gridMs = ElapsedMs(start) / frames;
+
+        printf("%8zu | %14s %10s | %14zu %10.3f %10zu\n",
+               count, bruteTested, bruteMs, pairs.size(), gridMs, contacts);
+    }
+    printf("\n");
+}
+
+// Prey scattered like InitializeBalls plus the two predators of SpawnPredators
+void BuildWorld(BallWorld& world, const AABB& room, size_t preyCount) {
+    std::vector<float> x, y, z;
+    SpawnOnFloor(room, preyCount, x, y, z);
+    for (size_t i = 0; i < preyCount; i++) {
+        DrawBall ball = world.Add(kBallRadius);
+        int points[] = { 15, 10, 5 };
+        float speeds[] = { 4.0f, 3.0f, 2.0f };
+        int type = rand() % 3;
+        ball.SetPoint(points[type]);
+        ball.SetPosition(glm::vec3(x[i], y[i], z[i]));
+        float vx = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * speeds[type];
+        float vz = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * speeds[type];
+        ball.SetVelocity(glm::vec3(vx, 0.0f, vz));
+    }
+
+    glm::vec3 roomMin = room.GetMin();
+    glm::vec3 center = (roomMin + room.GetMax()) * 0.5f;
+    DrawBall grey = world.Add(kBallRadius);
+    grey.SetPosition(glm::vec3(center.x - 2.0f, roomMin.y + kBallRadius, center.z - 2.0f));
+    grey.SetColor(glm::vec3(0.5f, 0.5f, 0.5f));
+    grey.SetIsPredator(true);
+    DrawBall purple = world.Add(kBallRadius);
+    purple.SetPosition(glm::vec3(center.x + 2.0f, roomMin.y + kBallRadius, center.z + 2.0f));
+    purple.SetColor(glm::vec3(0.5f, 0.0f, 0.5f));
+    purple.SetIsPredator(true);
+    world.StorePreviousPositions();
+}
+
+// 1, 2, 4, ... up to the hardware thread count
+std::vector<int> ThreadCounts() {
+    int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<int> threadCounts;
+    for (int t = 1; t < hardwareThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(hardwareThreads);
+    if (hardwareThreads == 1) {
+        threadCounts.push_back(2); // still exercises the worker path for the determinism check
+    }
+    return threadCounts;
+}
+
+// Integration::Integrate at each SIMD level on one thread, from the same world:
+// throughput in balls per ns, and the state must match the scalar kernel bit for bit.
+void BenchIntegration() {
+    printf("== Integration kernels (gravity + integrate + wall reflection, 1 thread) ==\n");
+    printf("%8s %8s | %10s %10s %8s | %16s %10s\n", "balls", "kernel", "us/tick", "balls/ns", "speedup", "state hash", "vs scalar");
+
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 };
+    const size_t counts[] = { 4096, 100000, 1000000 };
+    for (size_t count : counts) {
+        AABB room = ScaledRoom(count, 1000);
+        BallWorld reference;
+        srand(1);
+        BuildWorld(reference, room, count);
+        size_t balls = reference.Size();
+        int ticks = static_cast<int>(std::max<size_t>(20, 100000000 / balls));
+
+        double scalarNs = 0.0;
+        uint64_t scalarHash = 0;
+        for (SimdLevel level : levels) {
+            if (!Simd::IsSupported(level)) {
+                printf("%8zu %8s | %10s\n", balls, Simd::Name(level), "not supported by this CPU");
+                continue;
+            }
+            BallWorld world = reference;
+            Clock::time_point start = Clock::now();
+            for (int t = 0; t < ticks; t++) {
+                Integration::Integrate(level, world, 0, balls, 1.0f / 120.0f, room);
+            }
+            double ns = ElapsedMs(start) * 1e6 / ticks;
+            uint64_t hash = world.StateHash();
+            if (level == SimdLevel::Scalar) {
+                scalarNs = ns;
+                scalarHash = hash;
+            }
+            printf("%8zu %8s | %10.2f %10.3f %7.2fx | %016llx %10s\n",
+                   balls, Simd::Name(level), ns / 1000.0, balls / ns, scalarNs / ns,
+                   static_cast<unsigned long long>(hash), hash == scalarHash ? "same" : "DIFFERS");
+        }
+    }
+    printf("\n");
+}
+
+// The exact test on the grid's candidate pairs: one AABB::SphereToSphere
+// (glm::length, a sqrt) per pair as the contact pass used to do it, against
+// Narrowphase::FindContacts on the packed pair list at each SIMD level. Every
+// level must find the same contacts, with the same normals and depths, as the
+// old test followed by the resolver's own length and normal.
+void BenchNarrowphase() {
+    printf("== Narrowphase: per-pair SphereToSphere vs batched FindContacts (100k balls) ==\n");
+    printf("%10s %8s | %10s %8s | %10s %10s %8s | %8s\n",
+           "density", "kernel", "pairs", "hits", "ns/pair", "pairs/ns", "speedup", "vs old");
+
+    const size_t count = 100000;
+    const size_t densities[] = { 1000, 3000 }; // balls the fixed room would hold
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 };
+    for (size_t density : densities) {
+        AABB room = ScaledRoom(count, density);
+        BallWorld world;
+        srand(1);
+        BuildWorld(world, room, count);
+        SpatialGrid grid;
+        std::vector<SpatialGrid::Pair> pairs;
+        grid.Build(room, 2.0f * kBallRadius, world.posX.data(), world.posY.data(), world.posZ.data(), world.Size());
+        grid.FindPairs(pairs);
+        std::vector<uint32_t> pairA(pairs.size()), pairB(pairs.size());
+        for (size_t k = 0; k < pairs.size(); k++) {
+            pairA[k] = pairs[k].a;
+            pairB[k] = pairs[k].b;
+        }
+        const int repeats = 20;
+
+        // The old path: SphereToSphere per pair, then length and normal again for a hit
+        std::vector<Narrowphase::Contact> reference(pairs.size());
+        size_t hits = 0;
+        Clock::time_point start = Clock::now();
+        for (int r = 0; r < repeats; r++) {
+            hits = 0;
+            for (const auto& pair : pairs) {
+                glm::vec3 pos1(world.posX[pair.a], world.posY[pair.a], world.posZ[pair.a]);
+                glm::vec3 pos2(world.posX[pair.b], world.posY[pair.b], world.posZ[pair.b]);
+                if (AABB::SphereToSphere(pos1, world.radius[pair.a], pos2, world.radius[pair.b])) {
+                    glm::vec3 delta = pos2 - pos1;
+                    float distance = glm::length(delta);
+                    glm::vec3 normal = distance < Narrowphase::kMinDistance ? glm::vec3(0.0f) : delta / distance;
+                    reference[hits++] = { pair.a, pair.b, normal, world.radius[pair.a] + world.radius[pair.b] - distance };
+                }
+            }
+        }
+        double perPairNs = ElapsedMs(start) * 1e6 / repeats / pairs.size();
+        printf("%10zu %8s | %10zu %8zu | %10.3f %10.3f %7.2fx | %8s\n",
+               density, "per-pair", pairs.size(), hits, perPairNs, 1.0 / perPairNs, 1.0, "-");
+
+        reference.resize(hits);
+        for (SimdLevel level : levels) {
+            if (!Simd::IsSupported(level)) {
+                printf("%10zu %8s | %10s\n", density, Simd::Name(level), "not supported by this CPU");
+                continue;
+            }
+            std::vector<Narrowphase::Contact> contacts(pairs.size());
+            size_t found = 0;
+            start = Clock::now();
+            for (int r = 0; r < repeats; r++) {
+                found = Narrowphase::FindContacts(level, world, pairA.data(), pairB.data(), pairs.size(), contacts.data());
+            }
+            double ns = ElapsedMs(start) * 1e6 / repeats / pairs.size();
+            bool same = found == hits &&
+                        memcmp(contacts.data(), reference.data(), found * sizeof(Narrowphase::Contact)) == 0;
+            printf("%10zu %8s | %10zu %8zu | %10.3f %10.3f %7.2fx | %8s\n",
+                   density, Simd::Name(level), pairs.size(), found, ns, 1.0 / ns, perPairNs / ns, same ? "same" : "DIFFERS");
+        }
+    }
+    printf("\n");
+}
+
+// Prey avoidance for 100k prey: the direct scan over every predator (how
+// BallWorld::Update did it) against splatting the predators into the threat
+// field and sampling it. Error is the mean |force difference| over the mean
+// |force| of the threatened prey; "wake diff" counts prey whose in-range test
+// (and so wake-up) disagrees, all of them near the edge of the radius.
+void BenchThreatField() {
+    printf("== Threat field: predator scan vs splat + sample (100k prey, radius %.1f) ==\n", BallWorld::kWakeRadius);
+    printf("%10s %6s %6s | %10s %10s %10s %8s | %8s %10s\n",
+           "predators", "cell", "nodes", "scan ms", "build ms", "sample ms", "speedup", "error", "wake diff");
+
+    const size_t preyCount = 100000;
+    const float radius = BallWorld::kWakeRadius;
+    const size_t predatorCounts[] = { 2, 16, 128 };
+    const float cellSizes[] = { 0.1f, 0.25f, 0.5f };
+    srand(1);
+    std::vector<float> x, y, z;
+    SpawnOnFloor(kRoom, preyCount, x, y, z);
+    std::vector<glm::vec2> exact(preyCount), sampled(preyCount);
+    std::vector<uint8_t> exactThreatened(preyCount);
+
+    for (size_t predatorCount : predatorCounts) {
+        std::vector<float> px, py, pz;
+        SpawnOnFloor(kRoom, predatorCount, px, py, pz);
+
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < preyCount; i++) {
+            glm::vec3 position(x[i], y[i], z[i]);
+            glm::vec3 avoidanceForce(0.0f);
+            bool threatened = false;
+            for (size_t p = 0; p < predatorCount; p++) {
+                glm::vec3 toPredator = glm::vec3(px[p], py[p], pz[p]) - position;
+                float distance = glm::length(toPredator);
+                threatened |= distance < radius;
+                if (distance < radius && distance > 0.001f) {
+                    glm::vec3 avoidDirection = -glm::normalize(toPredator);
+                    avoidDirection.y = 0.0f;
+                    avoidDirection = glm::normalize(avoidDirection);
+                    avoidanceForce += avoidDirection * ((radius - distance) / radius) * 3.0f;
+                }
+            }
+            exact[i] = glm::vec2(avoidanceForce.x, avoidanceForce.z);
+            exactThreatened[i] = threatened;
+        }
+        double scanMs = ElapsedMs(start);
+
+        for (float cellSize : cellSizes) {
+            ThreatField field;
+            field.Configure(kRoom, cellSize, radius); // allocate outside the timing
+            start = Clock::now();
+            field.Configure(kRoom, cellSize, radius);
+            for (size_t p = 0; p < predatorCount; p++) {
+                field.Splat(px[p], pz[p]);
+            }
+            double buildMs = ElapsedMs(start);
+
+            size_t wakeDiff = 0;
+            start = Clock::now();
+            for (size_t i = 0; i < preyCount; i++) {
+                ThreatField::Sample sample = field.SampleAt(x[i], z[i]);
+                sampled[i] = sample.gradient * -3.0f;
+                wakeDiff += (sample.threat > 0.0f) != (exactThreatened[i] != 0);
+            }
+            double sampleMs = ElapsedMs(start);
+
+            double errorSum = 0.0, forceSum = 0.0;
+            for (size_t i = 0; i < preyCount; i++) {
+                if (!exactThreatened[i]) continue;
+                errorSum += glm::length(sampled[i] - exact[i]);
+                forceSum += glm::length(exact[i]);
+            }
+            printf("%10zu %6.2f %6d | %10.3f %10.3f %10.3f %7.1fx | %7.2f%% %10zu\n",
+                   predatorCount, cellSize, field.GetCountX() * field.GetCountZ(), scanMs, buildMs, sampleMs,
+                   scanMs / (buildMs + sampleMs), forceSum > 0.0 ? 100.0 * errorSum / forceSum : 0.0, wakeDiff);
+        }
+    }
+    printf("\n");
+}
+
+// BallWorld::Update (AI + avoidance + integration) on 1..N threads.
+// Every run starts from the same world and must end in the same state.
+void BenchAgentUpdate() {
+    printf("== Agent update scaling (BallWorld::Update, no collisions) ==\n");
+    printf("%8s %8s | %10s %8s | %16s %8s\n", "balls", "threads", "ms/tick", "speedup", "state hash", "vs 1");
+
+    std::vector<int> threadCounts = ThreadCounts();
+
+    const size_t counts[] = { 10000, 100000 };
+    const float dt = 1.0f / 120.0f;
+    for (size_t count : counts) {
+        AABB room = ScaledRoom(count, 1000);
+        srand(1);
+        BallWorld initial;
+        BuildWorld(initial, room, count);
+        int ticks = count <= 10000 ? 120 : 30;
+
+        double serialMs = 0.0;
+        uint64_t serialHash = 0;
+        for (int threads : threadCounts) {
+            JobSystem jobs(threads);
+            FrameArena arena;
+            BallWorld world = initial;
+            world.Update(dt, room, jobs, arena); // warm-up: first touch of the copied arrays
+
+            world = initial;
+            Clock::time_point start = Clock::now();
+            for (int tick = 0; tick < ticks; tick++) {
+                arena.Reset();
+                world.Update(dt, room, jobs, arena);
+            }
+            double ms = ElapsedMs(start) / ticks;
+            uint64_t hash = world.StateHash();
+            if (threads == 1) {
+                serialMs = ms;
+                serialHash = hash;
+            }
+            printf("%8zu %8d | %10.3f %7.2fx | %016llx %8s\n",
+                   count, threads, ms, serialMs / ms, static_cast<unsigned long long>(hash),
+                   hash == serialHash ? "same" : "DIFFERS");
+        }
+    }
+    printf("\n");
+}
+
+// Mass eating: mark every other prey, drop them with RemoveMarked, then check
+// that removed handles are dead and every survivor's handle finds its own index
+void BenchRemoval() {
+    printf("== Removal (RemoveMarked, every other prey eaten) ==\n");
+    printf("%8s %8s | %10s | %8s\n", "balls", "removed", "ms", "handles");
+
+    const size_t counts[] = { 10000, 100000 };
+    for (size_t count : counts) {
+        srand(1);
+        BallWorld world;
+        BuildWorld(world, kRoom, count);
+
+        std::vector<BallHandle> eaten;
+        for (size_t i = 0; i < count; i += 2) {
+            eaten.push_back(world.handle[i]);
+            world.MarkRemoved(i);
+        }
+
+        Clock::time_point start = Clock::now();
+        world.RemoveMarked();
+        double ms = ElapsedMs(start);
+
+        bool ok = world.Size() == count + 2 - eaten.size();
+        for (BallHandle h : eaten) {
+            ok = ok && !world.IsAlive(h);
+        }
+        for (size_t i = 0; i < world.Size(); i++) {
+            ok = ok && world.IndexOf(world.handle[i]) == static_cast<int>(i);
+        }
+        // Recycled slots must hand out handles the old ones do not match
+        DrawBall reborn = world.Add(kBallRadius);
+        for (BallHandle h : eaten) {
+            ok = ok && h != reborn.GetHandle();
+        }
+
+        printf("%8zu %8zu | %10.3f | %8s\n", count, eaten.size(), ms, ok ? "ok" : "BROKEN");
+    }
+    printf("\n");
+}
+
+// Respawning a population: one Add per ball into a fresh world (heap growth
+// included) vs Clear + AddBatch into a pool reserved up front
+void BenchPoolReset() {
+    printf("== Pool reset (drop every ball, respawn the same count) ==\n");
+    printf("%8s | %12s | %12s %12s | %8s\n", "balls", "Add us", "Clear us", "Batch us", "handles");
+
+    const size_t counts[] = { 10000, 100000 };
+    const int rounds = 20;
+    for (size_t count : counts) {
+        double addUs = 0.0;
+        for (int r = 0; r < rounds; r++) {
+            Clock::time_point start = Clock::now();
+            BallWorld fresh;
+            for (size_t i = 0; i < count; i++) {
+                fresh.Add(kBallRadius);
+            }
+            addUs += ElapsedMs(start) * 1000.0;
+        }
+
+        BallWorld pool;
+        pool.Reserve(count);
+        pool.AddBatch(count, kBallRadius);
+        std::vector<BallHandle> stale(pool.handle);
+        double clearUs = 0.0, batchUs = 0.0;
+        for (int r = 0; r < rounds; r++) {
+            Clock::time_point start = Clock::now();
+            pool.Clear();
+            clearUs += ElapsedMs(start) * 1000.0;
+            start = Clock::now();
+            pool.AddBatch(count, kBallRadius);
+            batchUs += ElapsedMs(start) * 1000.0;
+        }
+
+        bool ok = pool.Size() == count && pool.Capacity() == count;
+        for (BallHandle h : stale) {
+            ok = ok && !pool.IsAlive(h);
+        }
+        for (size_t i = 0; i < pool.Size(); i++) {
+            ok = ok && pool.IndexOf(pool.handle[i]) == static_cast<int>(i);
+        }
+        printf("%8zu | %12.1f | %12.1f %12.1f | %8s\n",
+               count, addUs / rounds, clearUs / rounds, batchUs / rounds, ok ? "ok" : "BROKEN");
+    }
+    printf("\n");
+}
+
+int PreyLeft(Simulation& simulation) {
+    BallWorld& world = simulation.GetWorld();
+    int prey = 0;
+    for (size_t i = 0; i < world.Size(); i++) {
+        prey += (world.flags[i] & BallWorld::kPredator) == 0;
+    }
+    return prey;
+}
+
+// One ball of radius 0.1 moving at `speed` for one step past a resting one;
+// the reference samples the path at 256 points. Reports how many real contacts
+// the end-of-step overlap test and the swept test miss, and what each costs.
+void BenchSweptPrimitive() {
+    printf("%8s %8s | %10s %8s | %10s %8s | %8s\n",
+           "speed", "step Hz", "disc ns", "missed", "swept ns", "missed", "contacts");
+
+    const float speeds[] = { 5.0f, 10.0f };
+    const int rates[] = { 120, 30, 10 };
+    const size_t cases = 200000;
+    const float r = kBallRadius;
+    for (float speed : speeds) {
+        for (int hz : rates) {
+            float step = speed / hz;
+            std::vector<glm::vec3> start(cases), end(cases), target(cases);
+            srand(7);
+            for (size_t c = 0; c < cases; c++) {
+                auto unit = []() { return static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f; };
+                glm::vec3 dir = glm::normalize(glm::vec3(unit(), 0.0f, unit()) + glm::vec3(1e-3f, 0.0f, 0.0f));
+                start[c] = glm::vec3(unit(), 0.0f, unit()) * (step + 2.0f * r);
+                end[c] = start[c] + dir * step;
+                target[c] = glm::vec3(0.0f);
+            }
+
+            size_t contacts = 0;
+            std::vector<uint8_t> truth(cases);
+            for (size_t c = 0; c < cases; c++) {
+                if (glm::length(start[c] - target[c]) < 2.0f * r) continue; // already touching
+                for (int k = 0; k <= 256 && !truth[c]; k++) {
+                    glm::vec3 p = start[c] + (end[c] - start[c]) * (k / 256.0f);
+                    truth[c] = glm::length(p - target[c]) < 2.0f * r;
+                }
+                contacts += truth[c];
+            }
+
+            size_t discMissed = 0, sweptMissed = 0;
+            Clock::time_point t0 = Clock::now();
+            for (size_t c = 0; c < cases; c++) {
+                bool hit = AABB::SphereToSphere(end[c], r, target[c], r);
+                discMissed += truth[c] && !hit;
+            }
+            double discNs = ElapsedMs(t0) * 1e6 / cases;
+            t0 = Clock::now();
+            for (size_t c = 0; c < cases; c++) {
+                float t;
+                bool hit = AABB::SweptSphereToSphere(start[c], end[c], r, target[c], target[c], r, t);
+                sweptMissed += truth[c] && !hit;
+            }
+            double sweptNs = ElapsedMs(t0) * 1e6 / cases;
+            printf("%8.1f %8d | %10.2f %7.1f%% | %10.2f %7.1f%% | %8zu\n",
+                   speed, hz, discNs, 100.0 * discMissed / contacts, sweptNs, 100.0 * sweptMissed / contacts, contacts);
+        }
+    }
+
+    // Pairs that already overlap at the start of the step: a contact only
+    // when they are moving closer, never when they are moving apart
+    size_t approaching = 0, separating = 0, approachingHits = 0, separatingHits = 0;
+    srand(11);
+    for (size_t c = 0; c < cases; c++) {
+        auto unit = []() { return static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f; };
+        glm::vec3 offset = glm::normalize(glm::vec3(unit(), 0.0f, unit()) + glm::vec3(1e-3f, 0.0f, 0.0f));
+        glm::vec3 dir = glm::normalize(glm::vec3(unit(), 0.0f, unit()) + glm::vec3(0.0f, 0.0f, 1e-3f));
+        glm::vec3 start = offset * (1.5f * r);
+        glm::vec3 end = start + dir * (5.0f / 30.0f);
+        float t;
+        bool hit = AABB::SweptSphereToSphere(start, end, r, glm::vec3(0.0f), glm::vec3(0.0f), r, t);
+        if (glm::dot(dir, offset) < 0.0f) {
+            approaching++;
+            approachingHits += hit && t == 0.0f;
+        } else {
+            separating++;
+            separatingHits += hit;
+        }
+    }
+    printf("Overlapping at the start: %zu of %zu approaching pairs hit at t = 0, %zu of %zu separating pairs hit\n",
+           approachingHits, approaching, separatingHits, separating);
+}
+
+// InitializeBalls on 1..N threads: spawn randoms come from the counter RNG
+// keyed by ball handle, so the spawned world is the same for any thread count.
+void BenchSpawning() {
+    printf("== Spawning (Simulation::InitializeBalls, counter RNG) ==\n");
+    printf("%8s %8s | %10s %8s | %16s %8s\n", "balls", "threads", "ms", "speedup", "state hash", "vs 1");
+
+    std::vector<int> threadCounts = ThreadCounts();
+    const int counts[] = { 100000, 1000000 };
+    for (int count : counts) {
+        AABB room = ScaledRoom(count, 1000);
+        double serialMs = 0.0;
+        uint64_t serialHash = 0;
+        for (int threads : threadCounts) {
+            Simulation simulation(room);
+            simulation.SetThreadCount(threads);
+            simulation.Reserve(count);
+
+            Clock::time_point start = Clock::now();
+            simulation.InitializeBalls(count);
+            double ms = ElapsedMs(start);
+            uint64_t hash = simulation.GetWorld().StateHash();
+            if (threads == 1) {
+                serialMs = ms;
+                serialHash = hash;
+            }
+            printf("%8d %8d | %10.3f %7.2fx | %016llx %8s\n",
+                   count, threads, ms, serialMs / ms, static_cast<unsigned long long>(hash),
+                   hash == serialHash ? "same" : "DIFFERS");
+        }
+    }
+    printf("\n");
+}
+
+// Starting a big scenario from a snapshot instead of spawning it: save, then
+// load into a second simulation; both must continue in lockstep afterwards.
+// "load" goes into a new simulation and pays the first touch of its pool;
+// "reload" loads again into the same, already sized pool.
+void BenchSnapshot() {
+    printf("== World snapshot: spawn vs mmap load ==\n");
+    printf("%8s | %10s | %10s %10s %10s %8s | %8s\n", "balls", "spawn ms", "save ms", "load ms", "reload ms", "MB", "same");
+
+    const int counts[] = { 100000, 1000000 };
+    const char* path = "bench_snapshot.bwsnap";
+    for (int count : counts) {
+        AABB room = ScaledRoom(count, 1000);
+        Simulation original(room);
+        original.Reserve(count);
+        Clock::time_point start = Clock::now();
+        original.Restart(1, count);
+        double spawnMs = ElapsedMs(start);
+        original.Step(1.0f / 120.0f); // some motion, so velocities and targets are set
+
+        start = Clock::now();
+        bool ok = WorldSnapshot::Save(path, original);
+        double saveMs = ElapsedMs(start);
+
+        Simulation loaded(kRoom);
+        start = Clock::now();
+        ok = ok && WorldSnapshot::Load(path, loaded);
+        double loadMs = ElapsedMs(start);
+        start = Clock::now();
+        ok = ok && WorldSnapshot::Load(path, loaded);
+        double reloadMs = ElapsedMs(start);
+
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        double megabytes = file ? static_cast<double>(file.tellg()) / (1024.0 * 1024.0) : 0.0;
+        ok = ok && loaded.StateHash() == original.StateHash();
+        original.Step(1.0f / 120.0f);
+        loaded.Step(1.0f / 120.0f);
+        ok = ok && loaded.StateHash() == original.StateHash();
+        printf("%8d | %10.3f | %10.3f %10.3f %10.3f %8.1f | %8s\n",
+               count, spawnMs, saveMs, loadMs, reloadMs, megabytes, ok ? "yes" : "NO");
+    }
+    std::remove(path);
+    printf("\n");
+}
+
+// Calls f on the slot table arrays (slot -> index, generation, free list),
+// the last three ForEachStateArray arrays
+template <typename F>
+void WithSlotTable(BallWorld& world, F&& f) {
+    size_t total = 0;
+    world.ForEachStateArray([&total](auto&) { total++; });
+    std::vector<std::vector<uint32_t>*> table;
+    size_t position = 0;
+    world.ForEachStateArray([&](auto& values) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(values)>, std::vector<uint32_t>>) {
+            if (position >= total - 3) table.push_back(&values);
+        }
+        position++;
+    });
+    f(*table[0], *table[1], *table[2]);
+}
+
+// Snapshots whose handles disagree with their slot table must be rejected
+// and leave the loading simulation as it was
+void BenchSnapshotValidation() {
+    printf("== World snapshot: corrupt slot tables ==\n");
+    printf("%28s | %8s %9s\n", "corruption", "rejected", "untouched");
+
+    using Slots = std::vector<uint32_t>;
+    struct Corruption {
+        const char* name;
+        void (*apply)(BallWorld& world, Slots& slotIndex, Slots& generation, Slots& freeSlots);
+    };
+    const Corruption corruptions[] = {
+        { "handle slot out of range", [](BallWorld& w, Slots& index, Slots&, Slots&) {
+              w.handle[5] = (w.handle[5] & ~BallWorld::kMaxSlots) | static_cast<uint32_t>(index.size() + 7); } },
+        { "handle generation", [](BallWorld& w, Slots&, Slots&, Slots&) { w.handle[5] += 1u << BallWorld::kSlotBits; } },
+        { "slot index to another ball", [](BallWorld& w, Slots& index, Slots&, Slots&) {
+              index[w.handle[5] & BallWorld::kMaxSlots] = 6; } },
+        { "slot index past the balls", [](BallWorld& w, Slots& index, Slots&, Slots&) {
+              index[w.handle[5] & BallWorld::kMaxSlots] = static_cast<uint32_t>(w.Size() + 100); } },
+        { "generation table short", [](BallWorld&, Slots&, Slots& generation, Slots&) { generation.pop_back(); } },
+        { "free slot out of range", [](BallWorld&, Slots& index, Slots&, Slots& freeSlots) {
+              freeSlots.push_back(static_cast<uint32_t>(index.size() + 3)); } },
+        { "free slot that is live", [](BallWorld& w, Slots&, Slots&, Slots& freeSlots) {
+              freeSlots.push_back(w.handle[0] & BallWorld::kMaxSlots); } },
+        { "target slot out of range", [](BallWorld& w, Slots& index, Slots&, Slots&) {
+              w.targetHandle[w.Size() - 1] = static_cast<uint32_t>(index.size() + 9); } },
+        { "target on a free slot", [](BallWorld& w, Slots& index, Slots& generation, Slots& freeSlots) {
+              uint32_t slot = static_cast<uint32_t>(index.size());
+              index.push_back(static_cast<uint32_t>(w.Size() + 5)); // left over from the ball that had it
+              generation.push_back(3);
+              freeSlots.push_back(slot);
+              w.targetHandle[w.Size() - 1] = (3u << BallWorld::kSlotBits) | slot; } },
+        { "fsm state", [](BallWorld& w, Slots&, Slots&, Slots&) { w.fsmState[w.Size() - 1] = static_cast<FSMState>(7); } },
+    };
+
+    const char* path = "bench_corrupt.bwsnap";
+    Simulation target(kRoom);
+    target.Restart(2, 500);
+    target.Step(1.0f / 120.0f);
+    uint64_t targetHash = target.StateHash();
+    for (const Corruption& corruption : corruptions) {
+        Simulation source(kRoom);
+        source.Restart(1, 1000);
+        source.Step(1.0f / 120.0f);
+        BallWorld& world = source.GetWorld();
+        WithSlotTable(world, [&](Slots& slotIndex, Slots& generation, Slots& freeSlots) {
+            corruption.apply(world, slotIndex, generation, freeSlots);
+        });
+        bool rejected = WorldSnapshot::Save(path, source) && !WorldSnapshot::Load(path, target);
+        bool untouched = target.StateHash() == targetHash && target.GetTick() == 1;
+        printf("%28s | %8s %9s\n", corruption.name, rejected ? "yes" : "NO", untouched ? "yes" : "NO");
+    }
+
+    // A stale target (an older generation of its slot, as left by prey eaten
+    // after the AI pass) is valid state and must still load
+    Simulation source(kRoom);
+    source.Restart(1, 1000);
+    source.Step(1.0f / 120.0f);
+    BallWorld& world = source.GetWorld();
+    world.targetHandle[world.Size() - 1] = world.handle[0] - (1u << BallWorld::kSlotBits);
+    bool loaded = WorldSnapshot::Save(path, source) && WorldSnapshot::Load(path, target);
+    printf("%28s | %8s %9s\n", "stale target (valid)", loaded ? "no" : "YES", "-");
+    std::remove(path);
+    printf("\n");
+}
+
+// Capturing every tick into a 64 MB RewindBuffer: capture cost next to the
+// step it follows, image vs stored bytes per tick, how many ticks the budget
+// holds, and whether a restored tick re-steps into the hash it had the first time.
+void BenchRewind() {
+    printf("== Rewind buffer (capture every tick, 64 MB budget) ==\n");
+    printf("%8s | %10s %10s | %10s %10s %8s | %8s %10s | %8s\n",
+           "balls", "step ms", "capture ms", "image KB", "stored KB", "ratio", "ticks", "restore ms", "same");
+
+    const int counts[] = { 1000, 10000, 50000 };
+    const int ticks = 600;
+    for (int count : counts) {
+        Simulation simulation(ScaledRoom(count, 1000));
+        simulation.Reserve(count);
+        simulation.Restart(1, count);
+        RewindBuffer rewind(64u << 20);
+        rewind.Capture(simulation);
+
+        std::vector<uint64_t> hashes(ticks + 1);
+        double stepMs = 0.0;
+        for (int t = 1; t <= ticks; t++) {
+            Clock::time_point start = Clock::now();
+            simulation.Step(1.0f / 120.0f);
+            stepMs += ElapsedMs(start);
+            hashes[t] = simulation.StateHash();
+            rewind.Capture(simulation);
+        }
+
+        // Halfway back through the retained history
+        uint32_t tick = (rewind.GetOldestTick() + rewind.GetNewestTick()) / 2;
+        Clock::time_point start = Clock::now();
+        bool ok = rewind.Restore(tick, simulation);
+        double restoreMs = ElapsedMs(start);
+        ok = ok && simulation.StateHash() == hashes[tick];
+        simulation.Step(1.0f / 120.0f);
+        ok = ok && simulation.StateHash() == hashes[tick + 1];
+
+        double storedKB = rewind.GetUsedBytes() / 1024.0 / rewind.GetFrameCount();
+        double imageKB = rewind.GetLastImageBytes() / 1024.0;
+        printf("%8d | %10.3f %10.3f | %10.1f %10.1f %7.1fx | %8zu %10.3f | %8s\n",
+               count, stepMs / ticks, rewind.GetAverageCaptureMs(), imageKB, storedKB, imageKB / storedKB,
+               rewind.GetFrameCount(), restoreMs, ok ? "yes" : "NO");
+    }
+    printf("\n");
+}
+
+// Simulation::Step (agent update + contact generation + coloured batches) on
+// 1..N threads; every run must end in the same state.
+void BenchStepScaling() {
+    printf("== Full step scaling (Simulation::Step, contacts resolved in coloured batches) ==\n");
+    printf("%8s %8s | %10s %8s | %16s %8s\n", "balls", "threads", "ms/step", "speedup", "state hash", "vs 1");
+
+    std::vector<int> threadCounts = ThreadCounts();
+
+    const int counts[] = { 10000, 100000 };
+    const float dt = 1.0f / 120.0f;
+    for (int count : counts) {
+        AABB room = ScaledRoom(count, 300); // dense enough for plenty of contacts
+        int steps = count <= 10000 ? 60 : 10;
+        double serialMs = 0.0;
+        uint64_t serialHash = 0;
+        for (int threads : threadCounts) {
+            Simulation simulation(room);
+            simulation.SetThreadCount(threads);
+            simulation.Reserve(count);
+            simulation.InitializeBalls(count);
+            simulation.SpawnPredators();
+            simulation.Step(dt); // warm-up
+
+            Clock::time_point start = Clock::now();
+            for (int s = 0; s < steps; s++) {
+                simulation.Step(dt);
+            }
+            double ms = ElapsedMs(start) / steps;
+            uint64_t hash = simulation.GetWorld().StateHash();
+            if (threads == 1) {
+                serialMs = ms;
+                serialHash = hash;
+            }
+            printf("%8d %8d | %10.3f %7.2fx | %016llx %8s\n",
+                   count, threads, ms, serialMs / ms, static_cast<unsigned long long>(hash),
+                   hash == serialHash ? "same" : "DIFFERS");
+        }
+    }
+    printf("\n");
+}
+
+// Discrete overlap test vs the swept pass, through Simulation::Step with fast
+// predators. Larger steps move balls further than their radius per step: the
+// discrete test then lets predators pass through prey, the swept one does not.
+void BenchContinuousCollision() {
+    printf("== Collisions: discrete vs continuous ==\n");
+    BenchSweptPrimitive();
+    printf("\nFull step, predator speed 10, 5 s (200 balls) / 2 s (10k balls) simulated:\n");
+    printf("%8s %8s | %10s %8s | %10s %8s | %8s\n",
+           "balls", "step Hz", "disc ms", "eaten", "swept ms", "eaten", "cost");
+
+    const int counts[] = { 200, 10000 };
+    const int rates[] = { 120, 30, 10 };
+    for (int count : counts) {
+        AABB room = ScaledRoom(count, 1000);
+        for (int hz : rates) {
+            float dt = 1.0f / hz;
+            int steps = count <= 1000 ? 5 * hz : 2 * hz;
+            double ms[2];
+            int eaten[2];
+            for (int swept = 0; swept < 2; swept++) {
+                Simulation simulation(room);
+                simulation.SetContinuousCollision(swept != 0);
+                simulation.SetPredatorSpeed(10.0f);
+                simulation.Reserve(count);
+                simulation.InitializeBalls(count);
+                simulation.SpawnPredators();
+
+                Clock::time_point start = Clock::now();
+                for (int s = 0; s < steps; s++) {
+                    simulation.Step(dt);
+                }
+                ms[swept] = ElapsedMs(start) / steps;
+                eaten[swept] = count - PreyLeft(simulation);
+            }
+            printf("%8d %8d | %10.3f %8d | %10.3f %8d | %7.2fx\n",
+                   count, hz, ms[0], eaten[0], ms[1], eaten[1], ms[1] / ms[0]);
+        }
+    }
+
+    // Two hand-placed scenes on the floor, prey of the fastest kind, no gravity,
+    // one 10 Hz step: ball 0 moves along x at 4 (0.4 per step, 4 radii).
+    // - "two in reach": ball 0 ends overlapping both ball 1 (its first contact)
+    //   and ball 2, which it reaches later. Both are pushed apart; the two
+    //   pushes work against each other, so a little overlap may be left, as
+    //   with the discrete pass.
+    // - "moving apart": ball 0 starts overlapping ball 1 and moves away from it;
+    //   it must not be put back at its start or turned around.
+    auto runScene = [](const std::vector<glm::vec2>& xz, float velocity, auto&& report) {
+        Simulation simulation(kRoom);
+        simulation.SetSleeping(false);
+        simulation.Reserve(xz.size());
+        simulation.InitializeBalls(xz.size());
+        BallWorld& world = simulation.GetWorld();
+        float y = kRoom.GetMin().y + kBallRadius;
+        for (size_t i = 0; i < xz.size(); i++) {
+            DrawBall ball = world.Ball(i);
+            ball.SetPosition(glm::vec3(xz[i].x, y, xz[i].y));
+            ball.SetVelocity(glm::vec3(i == 0 ? velocity : 0.0f, 0.0f, 0.0f));
+            ball.SetGravity(0.0f);
+            world.point[i] = 15;
+        }
+        simulation.Step(0.1f);
+        report(world);
+    };
+    runScene({ { -0.4f, 0.0f }, { -0.02f, 0.17f }, { 0.0f, -0.18f } }, 4.0f, [](BallWorld& world) {
+        float deepest = 0.0f;
+        for (size_t i = 0; i < world.Size(); i++) {
+            for (size_t j = i + 1; j < world.Size(); j++) {
+                glm::vec3 delta(world.posX[j] - world.posX[i], world.posY[j] - world.posY[i], world.posZ[j] - world.posZ[i]);
+                deepest = std::max(deepest, world.radius[i] + world.radius[j] - glm::length(delta));
+            }
+        }
+        printf("Two in reach: deepest overlap left %.1f%% of a radius (the path ends 29%% into ball 1, 20%% into ball 2)\n",
+               100.0f * deepest / kBallRadius);
+    });
+    runScene({ { 0.0f, 0.0f }, { 0.15f, 0.0f } }, -4.0f, [](BallWorld& world) {
+        printf("Moving apart: ball 0 at x %.2f, velocity %.1f (expected -0.40, -4.0)\n",
+               world.posX[0], world.velX[0]);
+    });
+    printf("\n");
+}
+
+// Step cost of a scene where most prey have come to rest: 9 in 10 prey start
+// still and drop asleep after kSleepDelay, the rest keep moving.
+void BenchSleeping() {
+    printf("== Sleeping: idle-majority scene, 120 Hz (density of 100 balls) ==\n");
+    printf("%8s | %10s | %10s %8s | %8s\n", "balls", "awake ms", "sleep ms", "asleep", "speedup");
+
+    const int counts[] = { 10000, 100000 };
+    for (int count : counts) {
+        AABB room = ScaledRoom(count, 100);
+        double ms[2];
+        size_t asleep = 0;
+        for (int sleep = 0; sleep < 2; sleep++) {
+            Simulation simulation(room);
+            simulation.SetSleeping(sleep != 0);
+            simulation.Reserve(count);
+            simulation.InitializeBalls(count);
+            simulation.SpawnPredators();
+            BallWorld& world = simulation.GetWorld();
+            for (size_t i = 0; i < world.Size(); i++) {
+                if (!(world.flags[i] & BallWorld::kPredator) && i % 10 != 0) {
+                    world.Ball(i).SetVelocity(glm::vec3(0.0f));
+                }
+            }
+
+            const float dt = 1.0f / 120.0f;
+            for (int s = 0; s < 120; s++) { // settle: long enough to fall asleep
+                simulation.Step(dt);
+            }
+            const int steps = 120;
+            Clock::time_point start = Clock::now();
+            for (int s = 0; s < steps; s++) {
+                simulation.Step(dt);
+            }
+            ms[sleep] = ElapsedMs(start) / steps;
+            if (sleep) {
+                asleep = world.CountAsleep();
+            }
+        }
+        printf("%8d | %10.3f | %10.3f %8zu | %7.2fx\n", count, ms[0], ms[1], asleep, ms[0] / ms[1]);
+    }
+    printf("\n");
+}
+
+// The pre-grid SelectTargetFSM: every ball, front to back
+int LinearSelectTargetFSM(const BallWorld& world, size_t predator) {
+    int bestTarget = -1;
+    float bestScore = -1.0f;
+    glm::vec3 position(world.posX[predator], world.posY[predator], world.posZ[predator]);
+    for (size_t i = 0; i < world.Size(); i++) {
+        if (world.flags[i] & BallWorld::kPredator) continue;
+        glm::vec3 preyPosition(world.posX[i], world.posY[i], world.posZ[i]);
+        float distance = glm::length(preyPosition - position);
+        if (distance > 10.0f) continue;
+        float score = static_cast<float>(world.point[i]) / (distance + 0.1f);
+        if (score > bestScore) {
+            bestScore = score;
+            bestTarget = static_cast<int>(i);
+        }
+    }
+    return bestTarget;
+}
+
+// Cost of one FSM target selection: full scan vs grid query.
+// The room grows with the ball count, so the prey within range stays constant.
+void BenchTargetSelection() {
+    printf("== Target selection: linear scan vs target grid (density of 1k balls) ==\n");
+    printf("%8s | %12s | %12s %12s | %8s\n", "balls", "scan us", "grid us", "build us", "same");
+
+    const size_t counts[] = { 1000, 10000, 100000 };
+    for (size_t count : counts) {
+        AABB room = ScaledRoom(count, 1000);
+        srand(1);
+        BallWorld world;
+        BuildWorld(world, room, count);
+        size_t grey = world.Size() - 2; // BuildWorld appends grey, then purple
+        DrawBall predator = world.Ball(grey);
+        const int selections = 200;
+
+        Clock::time_point start = Clock::now();
+        int linearTarget = -1;
+        for (int s = 0; s < selections; s++) {
+            linearTarget = LinearSelectTargetFSM(world, grey);
+        }
+        double scanUs = ElapsedMs(start) * 1000.0 / selections;
+
+        start = Clock::now();
+        for (int s = 0; s < selections; s++) {
+            world.BuildTargetGrid(room);
+        }
+        double buildUs = ElapsedMs(start) * 1000.0 / selections;
+
+        start = Clock::now();
+        int gridTarget = -1;
+        for (int s = 0; s < selections; s++) {
+            gridTarget = predator.SelectTargetFSM();
+        }
+        double gridUs = ElapsedMs(start) * 1000.0 / selections;
+
+        printf("%8zu | %12.2f | %12.2f %12.2f | %8s\n",
+               count, scanUs, gridUs, buildUs, linearTarget == gridTarget ? "yes" : "NO");
+    }
+    printf("\n");
+}
+
+// The string-dispatched fuzzy path the engine replaced, kept verbatim as the reference
+// Distance Membership Functions
+float LegacyDistanceMembership(float distance, const std::string& category) {
+    if (category == "Close") {
+        // Close: peak at 0, zero at 3
+        if (distance <= 0.5f) return 1.0f;
+        if (distance >= 3.0f) return 0.0f;
+        return (3.0f - distance) / 2.5f;
+    }
+    else if (category == "Medium") {
+        // Medium: peak at 3.5, zero at 1 and 6
+        if (distance <= 1.0f || distance >= 6.0f) return 0.0f;
+        if (distance <= 3.5f) return (distance - 1.0f) / 2.5f;
+        return (6.0f - distance) / 2.5f;
+    }
+    else if (category == "Far") {
+        // Far: peak at 7, zero at 4
+        if (distance <= 4.0f) return 0.0f;
+        if (distance >= 7.0f) return 1.0f;
+        return (distance - 4.0f) / 3.0f;
+    }
+    return 0.0f;
+}
+
+// Value Membership Functions  
+float LegacyValueMembership(int value, const std::string& category) {
+    if (category == "Low") {
+        // Low: peak at 5, zero at 8
+        if (value == 5) return 1.0f;
+        if (value >= 10) return 0.0f;
+        if (value < 5) return 1.0f;
+        return (10.0f - value) / 5.0f;
+    }
+    else if (category == "Medium") {
+        // Medium: peak at 10, zero at 5 and 15
+        if (value == 10) return 1.0f;
+        if (value <= 5 || value >= 15) return 0.0f;
+        if (value < 10) return (value - 5.0f) / 5.0f;
+        return (15.0f - value) / 5.0f;
+    }
+    else if (category == "High") {
+        // High: peak at 15, zero at 10
+        if (value == 15) return 1.0f;
+        if (value <= 10) return 0.0f;
+        if (value > 15) return 1.0f;
+        return (value - 10.0f) / 5.0f;
+    }
+    return 0.0f;
+}
+
+float LegacyFuzzyPriority(float distance, int preyValue) {
+    // Fuzzy Rules:
+    // 1. If distance is Close and value is High, then priority is VeryHigh
+    // 2. If distance is Close and value is Medium, then priority is High  
+    // 3. If distance is Medium and value is High, then priority is High
+    // 4. If distance is Far and value is High, then priority is Medium
+    // 5. If distance is Close and value is Low, then priority is Medium
+    // 6. If distance is Medium and value is Medium, then priority is Medium
+    // 7. If distance is Medium and value is Low, then priority is Low
+    // 8. If distance is Far and value is Medium, then priority is Low
+    // 9. If distance is Far and value is Low, then priority is VeryLow
+    
+    float totalWeight = 0.0f;
+    float weightedSum = 0.0f;
+    
+    // Rule 1: Close + High -> VeryHigh
+    float close = LegacyDistanceMembership(distance, "Close");
+    float high = LegacyValueMembership(preyValue, "High");
+    float weight1 = close * high;
+    if (weight1 > 0.0f) {
+        totalWeight += weight1;
+        weightedSum += weight1 * 0.9f; // VeryHigh = 0.9
+    }
+    
+    // Rule 2: Close + Medium -> High
+    float medium_val = LegacyValueMembership(preyValue, "Medium");
+    float weight2 = close * medium_val;
+    if (weight2 > 0.0f) {
+        totalWeight += weight2;
+        weightedSum += weight2 * 0.7f; // High = 0.7
+    }
+    
+    // Rule 3: Medium + High -> High
+    float medium_dist = LegacyDistanceMembership(distance, "Medium");
+    float weight3 = medium_dist * high;
+    if (weight3 > 0.0f) {
+        totalWeight += weight3;
+        weightedSum += weight3 * 0.7f; // High = 0.7
+    }
+    
+    // Rule 4: Far + High -> Medium
+    float far = LegacyDistanceMembership(distance, "Far");
+    float weight4 = far * high;
+    if (weight4 > 0.0f) {
+        totalWeight += weight4;
+        weightedSum += weight4 * 0.5f; // Medium = 0.5
+    }
+    
+    // Rule 5: Close + Low -> Medium
+    float low_val = LegacyValueMembership(preyValue, "Low");
+    float weight5 = close * low_val;
+    if (weight5 > 0.0f) {
+        totalWeight += weight5;
+        weightedSum += weight5 * 0.5f; // Medium = 0.5
+    }
+    
+    // Rule 6: Medium + Medium -> Medium
+    float weight6 = medium_dist * medium_val;
+    if (weight6 > 0.0f) {
+        totalWeight += weight6;
+        weightedSum += weight6 * 0.5f; // Medium = 0.5
+    }
+    
+    // Rule 7: Medium + Low -> Low
+    float weight7 = medium_dist * low_val;
+    if (weight7 > 0.0f) {
+        totalWeight += weight7;
+        weightedSum += weight7 * 0.3f; // Low = 0.3
+    }
+    
+    // Rule 8: Far + Medium -> Low
+    float weight8 = far * medium_val;
+    if (weight8 > 0.0f) {
+        totalWeight += weight8;
+        weightedSum += weight8 * 0.3f; // Low = 0.3
+    }
+    
+    // Rule 9: Far + Low -> VeryLow
+    float weight9 = far * low_val;
+    if (weight9 > 0.0f) {
+        totalWeight += weight9;
+        weightedSum += weight9 * 0.1f; // VeryLow = 0.1
+    }
+    
+    // Defuzzification using weighted average
+    if (totalWeight > 0.0f) {
+        return weightedSum / totalWeight;
+    }
+    
+    return 0.0f; // No applicable rules
+}
+
+// Bit-exactness sweep, then cost per scored candidate
+void BenchFuzzyPriority() {
+    printf("== Fuzzy priority: string dispatch vs compiled engine ==\n");
+    const FuzzyEngine& engine = PreyPriority::Engine();
+
+    // Every distance from 0 to 8 in steps of 0.001 against every value around 5 / 10 / 15
+    std::vector<float> sweepDistance, sweepValue;
+    std::vector<int> sweepIntValue;
+    const int values[] = { 0, 3, 5, 7, 10, 12, 15, 20 };
+    for (int v : values) {
+        for (int d = 0; d <= 8000; d++) {
+            sweepDistance.push_back(d * 0.001f);
+            sweepValue.push_back(static_cast<float>(v));
+            sweepIntValue.push_back(v);
+        }
+    }
+    std::vector<float> batch(sweepDistance.size());
+    engine.EvaluateBatch(sweepDistance.data(), sweepValue.data(), batch.data(), batch.size());
+    size_t scalarMismatches = 0, batchMismatches = 0;
+    for (size_t i = 0; i < sweepDistance.size(); i++) {
+        float legacy = LegacyFuzzyPriority(sweepDistance[i], sweepIntValue[i]);
+        float scalar = engine.Evaluate(sweepDistance[i], sweepValue[i]);
+        if (memcmp(&legacy, &scalar, sizeof(float)) != 0) scalarMismatches++;
+        if (memcmp(&legacy, &batch[i], sizeof(float)) != 0) batchMismatches++;
+    }
+    printf("%zu inputs: Evaluate differs on %zu, EvaluateBatch differs on %zu\n",
+           sweepDistance.size(), scalarMismatches, batchMismatches);
+
+    // Candidates as SelectTargetFuzzy sees them: within 7 units, 5 / 10 / 15 points
+    const size_t count = 100000;
+    srand(1);
+    std::vector<float> distance(count), value(count), priority(count);
+    std::vector<int> intValue(count);
+    for (size_t i = 0; i < count; i++) {
+        distance[i] = static_cast<float>(rand()) / RAND_MAX * 7.0f;
+        intValue[i] = 5 * (1 + rand() % 3);
+        value[i] = static_cast<float>(intValue[i]);
+    }
+    const int rounds = 20;
+    float sink = 0.0f;
+
+    Clock::time_point start = Clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            sink += LegacyFuzzyPriority(distance[i], intValue[i]);
+        }
+    }
+    double legacyNs = ElapsedMs(start) * 1e6 / (rounds * count);
+
+    start = Clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            sink += engine.Evaluate(distance[i], value[i]);
+        }
+    }
+    double scalarNs = ElapsedMs(start) * 1e6 / (rounds * count);
+
+    start = Clock::now();
+    for (int r = 0; r < rounds; r++) {
+        engine.EvaluateBatch(distance.data(), value.data(), priority.data(), count);
+        sink += priority[r];
+    }
+    double batchNs = ElapsedMs(start) * 1e6 / (rounds * count);
+
+    printf("%24s %10s %8s\n", "path", "ns/prey", "speedup");
+    printf("%24s %10.2f %7.2fx\n", "string dispatch (old)", legacyNs, 1.0);
+    printf("%24s %10.2f %7.2fx\n", "FuzzyEngine::Evaluate", scalarNs, legacyNs / scalarNs);
+    printf("%24s %10.2f %7.2fx\n", "FuzzyEngine::EvaluateBatch", batchNs, legacyNs / batchNs);
+    printf("(checksum %.3f)\n\n", sink);
+}
+
+// Thousands of predators whose reselection timers all run out on the same
+// tick: unbudgeted, that tick pays for every selection at once. With a budget
+// the selections spread over the following ticks. Every budget must end in the
+// same state on any thread count.
+void BenchAiScheduler() {
+    printf("== AI scheduler: selection budget (10k prey, 2k predators, 240 ticks) ==\n");
+    printf("%8s %8s | %10s %10s %10s | %10s %10s | %16s %8s\n", "budget", "threads", "ms/tick", "max ms",
+           "max ai ms", "max sel", "max defer", "state hash", "vs 1");
+
+    const size_t preyCount = 10000;
+    const size_t predatorCount = 2000;
+    const int budgets[] = { 0, 512, 128, 32 };
+    const int ticks = 240;
+    const float dt = 1.0f / 120.0f;
+    AABB room = ScaledRoom(preyCount, 1000);
+    srand(1);
+    BallWorld initial;
+    BuildWorld(initial, room, preyCount);
+    std::vector<float> x, y, z;
+    SpawnOnFloor(room, predatorCount, x, y, z);
+    for (size_t p = 0; p < predatorCount; p++) {
+        DrawBall predator = initial.Add(kBallRadius);
+        predator.SetPosition(glm::vec3(x[p], y[p], z[p]));
+        predator.SetColor(p % 2 == 0 ? glm::vec3(0.5f, 0.5f, 0.5f) : glm::vec3(0.5f, 0.0f, 0.5f));
+        predator.SetIsPredator(true);
+    }
+    initial.StorePreviousPositions();
+    std::vector<int> threadCounts = { 1, ThreadCounts().back() };
+
+    for (int budget : budgets) {
+        uint64_t serialHash = 0;
+        for (int threads : threadCounts) {
+            JobSystem jobs(threads);
+            FrameArena arena;
+            BallWorld world = initial;
+            world.Update(dt, room, jobs, arena); // warm-up: first touch of the copied arrays
+
+            world = initial;
+            world.GetAiScheduler().SetBudget(budget);
+            double totalMs = 0.0, maxMs = 0.0, maxAiMs = 0.0;
+            size_t maxGranted = 0, maxDeferred = 0;
+            for (int tick = 0; tick < ticks; tick++) {
+                arena.Reset();
+                Clock::time_point start = Clock::now();
+                world.Update(dt, room, jobs, arena);
+                double ms = ElapsedMs(start);
+                const AiScheduler& scheduler = world.GetAiScheduler();
+                totalMs += ms;
+                maxMs = std::max(maxMs, ms);
+                maxAiMs = std::max(maxAiMs, scheduler.GetLastMs());
+                maxGranted = std::max(maxGranted, scheduler.GetGrantedCount());
+                maxDeferred = std::max(maxDeferred, scheduler.GetDeferredCount());
+            }
+            uint64_t hash = world.StateHash();
+            if (threads == 1) {
+                serialHash = hash;
+            }
+            printf("%8d %8d | %10.3f %10.3f %10.3f | %10zu %10zu | %016llx %8s\n",
+                   budget, threads, totalMs / ticks, maxMs, maxAiMs, maxGranted, maxDeferred,
+                   static_cast<unsigned long long>(hash), hash == serialHash ? "same" : "DIFFERS");
+        }
+    }
+    printf("\n");
+}
+
+// The per-predator polling the selection timers replaced, kept as the reference:
+// every tick adds dt to every timer and fires the ones past the interval
+size_t PollTimers(std::vector<float>& elapsed, float dt, float interval, uint64_t& checksum, uint32_t tick) {
+    size_t fired = 0;
+    for (size_t i = 0; i < elapsed.size(); i++) {
+        elapsed[i] += dt;
+        if (elapsed[i] > interval) {
+            elapsed[i] = 0.0f;
+            checksum += (static_cast<uint64_t>(i) + 1) * tick;
+            fired++;
+        }
+    }
+    return fired;
+}
+
+// The purple predator's reselection delay, as scheduled by BallWorld::Update,
+// against the old per-tick timer (dt added up in float until past 1 s) at
+// several step sizes: each must pick the same tick.
+void BenchReselectDelay() {
+    printf("== Fuzzy reselection delay: scheduled vs accumulated timer ==\n");
+    printf("%10s | %10s %10s | %6s\n", "dt", "old ticks", "scheduled", "same");
+
+    const float steps[] = { 1.0f / 30.0f, 1.0f / 60.0f, 1.0f / 120.0f, 1.0f / 144.0f, 0.1f, 0.05f, 0.013f };
+    for (float dt : steps) {
+        uint32_t expected = 0;
+        for (float elapsed = 0.0f; !(elapsed > 1.0f); elapsed += dt) {
+            expected++;
+        }
+
+        srand(1);
+        BallWorld world;
+        BuildWorld(world, kRoom, 1000);
+        size_t purple = world.Size() - 1; // BuildWorld appends grey, then purple
+        JobSystem jobs(1);
+        FrameArena arena;
+        // Every selection that finds a target schedules the next one; all must agree
+        uint32_t scheduled = 0;
+        bool same = true;
+        for (int tick = 0; tick < 600; tick++) {
+            arena.Reset();
+            uint32_t before = world.selectionDueTick[purple];
+            world.Update(dt, kRoom, jobs, arena);
+            uint32_t after = world.selectionDueTick[purple];
+            if (after != before && after > world.GetTick() + 1) {
+                same = same && (scheduled == 0 || scheduled == after - world.GetTick());
+                scheduled = after - world.GetTick();
+            }
+        }
+        printf("%10.5f | %10u %10u | %6s\n", dt, expected, scheduled, same && scheduled == expected ? "yes" : "NO");
+    }
+
+    // Steps that are not finite and positive, and one so small the float sum
+    // stalls before 2^30 ticks: no reselection on the timer (0)
+    const float neverSteps[] = { 0.0f, -1.0f / 60.0f, std::nanf(""), INFINITY, 1e-30f };
+    printf("Never due (0 ticks):");
+    for (float dt : neverSteps) {
+        printf(" %g -> %u", dt, DrawBall::FuzzyReselectTicks(dt));
+    }
+    printf("\n\n");
+}
+
+// Timers that fire every interval seconds at 120 Hz with random phases, polled
+// vs kept in the TimerWheel. "idle" timers are all far in the future, like
+// predators busy chasing: polling still visits each, the wheel none of them.
+// Both must fire the same timers on the same ticks.
+void BenchSelectionTimers() {
+    printf("== Selection timers: per-agent polling vs timer wheel (600 ticks at 120 Hz) ==\n");
+    printf("%9s %8s | %10s %10s %8s | %9s %6s\n", "timers", "interval", "poll us", "wheel us", "speedup", "fired", "same");
+
+    const size_t counts[] = { 1000, 10000, 100000, 1000000 };
+    const float intervals[] = { 1.0f, 1000.0f };
+    const float dt = 1.0f / 120.0f;
+    const uint32_t ticks = 600;
+    for (float interval : intervals) {
+        // Ticks the polled timer takes to pass interval, float rounding included
+        uint32_t period = 0;
+        for (float elapsed = 0.0f; !(elapsed > interval); elapsed += dt) {
+            period++;
+        }
+        for (size_t count : counts) {
+            srand(1);
+            std::vector<float> elapsed(count, 0.0f);
+            TimerWheel wheel;
+            wheel.Resize(count);
+            wheel.Reset(0);
+            for (size_t i = 0; i < count; i++) {
+                uint32_t phase = static_cast<uint32_t>(rand()) % std::min(period, 1000u);
+                for (uint32_t k = 0; k < phase; k++) {
+                    elapsed[i] += dt;
+                }
+                wheel.Schedule(static_cast<uint32_t>(i), period - phase);
+            }
+
+            uint64_t pollChecksum = 0;
+            size_t pollFired = 0;
+            Clock::time_point start = Clock::now();
+            for (uint32_t tick = 1; tick <= ticks; tick++) {
+                pollFired += PollTimers(elapsed, dt, interval, pollChecksum, tick);
+            }
+            double pollUs = ElapsedMs(start) * 1000.0 / ticks;
+
+            uint64_t wheelChecksum = 0;
+            size_t wheelFired = 0;
+            start = Clock::now();
+            for (uint32_t tick = 1; tick <= ticks; tick++) {
+                wheel.Advance(tick, [&](uint32_t id) {
+                    wheelChecksum += (static_cast<uint64_t>(id) + 1) * tick;
+                    wheelFired++;
+                    wheel.Schedule(id, tick + period);
+                });
+            }
+            double wheelUs = ElapsedMs(start) * 1000.0 / ticks;
+
+            printf("%9zu %7s%s | %10.2f %10.2f %7.1fx | %9zu %6s\n", count, interval > 10.0f ? "" : "1 s",
+                   interval > 10.0f ? "    idle" : "", pollUs, wheelUs, pollUs / wheelUs, wheelFired,
+                   pollFired == wheelFired && pollChecksum == wheelChecksum ? "yes" : "NO");
+        }
+    }
+    printf("\n");
+}
+
+} // namespace
+
+int main() {
+    BenchBroadphase(false);
+    BenchBroadphase(true);
+    BenchAgentUpdate();
+    BenchThreatField();
+    BenchIntegration();
+    BenchNarrowphase();
+    BenchRemoval();
+    BenchPoolReset();
+    BenchContinuousCollision();
+    BenchSleeping();
+    BenchSpawning();
+    BenchSnapshot();
+    BenchSnapshotValidation();
+    BenchRewind();
+    BenchStepScaling();
+    BenchTargetSelection();
+    BenchFuzzyPriority();
+    BenchAiScheduler();
+    BenchSelectionTimers();
+    BenchReselectDelay();
+    return 0;
+}
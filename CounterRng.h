@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+
+// Counter-based random numbers (Philox4x32-10, Salmon et al. 2011).
+// A draw is a pure function of (seed, stream, tick, id, sub): there is no
+// state to advance, so any thread can compute any ball's numbers in any order
+// and get the same values. Callers pick a stream per use site and pass the
+// ball's handle as id, so two uses never share a counter.
+class CounterRng {
+public:
+    struct Block {
+        uint32_t v[4];
+    };
+
+    explicit CounterRng(uint64_t seed = 1) : seed(seed) {}
+
+    void SetSeed(uint64_t newSeed) { seed = newSeed; }
+    uint64_t GetSeed() const { return seed; }
+
+    // Four independent 32-bit values for one counter
+    Block Generate(uint32_t stream, uint32_t tick, uint32_t id, uint32_t sub = 0) const {
+        Block counter = { { id, sub, tick, stream } };
+        uint32_t key0 = static_cast<uint32_t>(seed);
+        uint32_t key1 = static_cast<uint32_t>(seed >> 32);
+        for (int round = 0; round < 10; round++) {
+            uint64_t product0 = static_cast<uint64_t>(kMul0) * counter.v[0];
+            uint64_t product1 = static_cast<uint64_t>(kMul1) * counter.v[2];
+            uint32_t hi0 = static_cast<uint32_t>(product0 >> 32), lo0 = static_cast<uint32_t>(product0);
+            uint32_t hi1 = static_cast<uint32_t>(product1 >> 32), lo1 = static_cast<uint32_t>(product1);
+            counter.v[0] = hi1 ^ counter.v[1] ^ key0;
+            counter.v[1] = lo1;
+            counter.v[2] = hi0 ^ counter.v[3] ^ key1;
+            counter.v[3] = lo0;
+            key0 += kWeyl0;
+            key1 += kWeyl1;
+        }
+        return counter;
+    }
+
+    // [0, 1) and [-1, 1) from the top 24 bits, exact in a float
+    static float ToUnit(uint32_t bits) { return static_cast<float>(bits >> 8) * (1.0f / 16777216.0f); }
+    static float ToSigned(uint32_t bits) { return ToUnit(bits) * 2.0f - 1.0f; }
+
+private:
+    static constexpr uint32_t kMul0 = 0xD2511F53u;
+    static constexpr uint32_t kMul1 = 0xCD9E8D57u;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9u;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85u;
+
+    uint64_t seed;
+};
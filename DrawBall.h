@@ -1,16 +1,9 @@
 #pragma once
 #include <glm/glm.hpp>
-#include <GL/glew.h>
-#include <vector>
-#include "Shader.h"
+#include <cstddef>
 #include "AABB.h"
 #include "BoundingSphere.h"
-
-// FSM States for Gray Predator
-enum class FSMState {
-    SelectTarget,
-    ChaseTarget
-};
+#include "BallWorld.h"
 
 // Fuzzy Logic structures for Purple Predator
 struct FuzzyInput {
@@ -22,70 +15,68 @@ struct FuzzyOutput {
     float priority;
 };
 
+// Lightweight view of one ball stored in a BallWorld.
+// Cheap to copy; only valid until the world removes balls.
 class DrawBall {
 private:
-    GLuint VAO;
-    int vertexCount;
-    glm::vec3 position;
-    glm::vec3 velocity;
-    glm::vec3 acceleration;
-    float scale;
-    float gravity;
-    glm::vec3 color;
-    bool isPredator;
-    BoundingSphere boundingBox; // 使用 BoundingSphere
-    bool isStationary;
-    int score; // 掠食者的積分
-    int point; // 一般球的分數值
-    
-    // AI Engine variables
-    FSMState currentState;
-    DrawBall* targetPrey;
-    float lastTargetSelectionTime;
-    float predatorSpeed;
+    BallWorld* world;
+    size_t index;
 
 public:
-    DrawBall(GLuint VAO, int vertexCount, float radius = 0.03f);
-    ~DrawBall();
+    DrawBall(BallWorld* world, size_t index) : world(world), index(index) {}
 
-    void UpdateBoundingSphere();
-    void Update(float deltaTime, const AABB& roomAABB);
-    void Update(float deltaTime, const AABB& roomAABB, const std::vector<DrawBall*>& balls);
-    void Render(Shader* shader, const glm::mat4& view, const glm::mat4& proj, const glm::vec3& cameraPos);
-    
     // AI Engine methods
-    void UpdateFSM(float deltaTime, const std::vector<DrawBall*>& preys);
-    void UpdateFuzzyLogic(float deltaTime, const std::vector<DrawBall*>& preys);
-    DrawBall* SelectTargetFSM(const std::vector<DrawBall*>& preys);
-    DrawBall* SelectTargetFuzzy(const std::vector<DrawBall*>& preys);
-    void ChaseTarget(float deltaTime);
-    float CalculateFuzzyPriority(const FuzzyInput& input);
-    float GetDistanceMembership(float distance, const std::string& category);
-    float GetValueMembership(int value, const std::string& category);
-    float GetPriorityMembership(float priority, const std::string& category);
+    // BallWorld::Update decides from the selection timers which predators
+    // pick a new target this tick (selectionGranted); the others keep doing
+    // what they were doing. Both set selectionDueTick for the next selection.
+    void UpdateFSM(float deltaTime, bool selectionGranted);
+    void UpdateFuzzyLogic(float deltaTime, bool selectionGranted);
+    int SelectTargetFSM() const;   // index of the best prey, -1 if none
+    int SelectTargetFuzzy() const; // index of the best prey, -1 if none
+    void ChaseTarget(float deltaTime, size_t targetIndex);
+    float CalculateFuzzyPriority(const FuzzyInput& input) const;
+    // Ticks from one fuzzy selection to the next at this step size, 0 if
+    // the interval never runs out (deltaTime not finite and positive).
+    // Slow for tiny steps; BallWorld caches it per deltaTime.
+    static uint32_t FuzzyReselectTicks(float deltaTime);
 
-    void SetPosition(const glm::vec3& pos) { position = pos; UpdateBoundingSphere(); }
-    void SetVelocity(const glm::vec3& vel) { velocity = vel; isStationary = false; }
-    void SetGravity(float g) { gravity = g; }
-    void SetScale(float s) { scale = s; boundingBox.radius = s; UpdateBoundingSphere(); }
-    void SetColor(const glm::vec3& c) { color = c; }
-    void SetIsPredator(bool predator) { isPredator = predator; }
-    void SetScore(int s) { score = s; }
-    void SetPoint(int p) { point = p; }
-    void SetPredatorSpeed(float speed) { predatorSpeed = speed; }
+    void SetPosition(const glm::vec3& pos) { world->posX[index] = pos.x; world->posY[index] = pos.y; world->posZ[index] = pos.z; }
+    void SetVelocity(const glm::vec3& vel) {
+        world->velX[index] = vel.x; world->velY[index] = vel.y; world->velZ[index] = vel.z;
+        world->WakeUp(index);
+    }
+    void SetGravity(float g) { world->gravity[index] = g; }
+    void SetScale(float s) { world->radius[index] = s; }
+    void SetColor(const glm::vec3& c) { world->color[index] = c; }
+    // A new predator selects its first target in the next Update
+    void SetIsPredator(bool predator) {
+        if (predator) {
+            world->flags[index] |= BallWorld::kPredator;
+            world->ScheduleTargetSelection(index, world->GetTick() + 1);
+        } else {
+            world->flags[index] &= ~BallWorld::kPredator;
+        }
+    }
+    void SetScore(int s) { world->score[index] = s; }
+    void SetPoint(int p) { world->point[index] = p; }
+    void SetPredatorSpeed(float speed) { world->predatorSpeed[index] = speed; }
     void ResetAIState(); // Reset AI state for predators
 
-    glm::vec3 GetPosition() const { return position; }
-    glm::vec3 GetVelocity() const { return velocity; }
-    float GetScale() const { return scale; }
-    glm::vec3 GetColor() const { return color; }
-    bool IsStationary() const { return isStationary; }
-    bool IsPredator() const { return isPredator; }
-    int GetScore() const { return score; }
-    int GetPoint() const { return point; }
-    FSMState GetCurrentState() const { return currentState; }
-    DrawBall* GetTargetPrey() const { return targetPrey; }
+    size_t GetIndex() const { return index; }
+    BallHandle GetHandle() const { return world->handle[index]; }
+    glm::vec3 GetPosition() const { return glm::vec3(world->posX[index], world->posY[index], world->posZ[index]); }
+    glm::vec3 GetVelocity() const { return glm::vec3(world->velX[index], world->velY[index], world->velZ[index]); }
+    float GetScale() const { return world->radius[index]; }
+    BoundingSphere GetBoundingSphere() const { return BoundingSphere(GetPosition(), GetScale()); }
+    glm::vec3 GetColor() const { return world->color[index]; }
+    bool IsStationary() const { return (world->flags[index] & BallWorld::kStationary) != 0; }
+    bool IsPredator() const { return (world->flags[index] & BallWorld::kPredator) != 0; }
+    int GetScore() const { return world->score[index]; }
+    int GetPoint() const { return world->point[index]; }
+    FSMState GetCurrentState() const { return world->fsmState[index]; }
+    // Index of the current target, -1 if there is none or it was eaten
+    int GetTargetPrey() const {
+        BallHandle target = world->targetHandle[index];
+        return target == BallWorld::kNullHandle ? -1 : world->IndexOf(target);
+    }
 };
-
-extern bool light1Enabled;
-extern bool light2Enabled;
\ No newline at end of file
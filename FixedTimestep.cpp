@@ -0,0 +1,40 @@
+#include "FixedTimestep.h"
+#include <algorithm>
+
+FixedTimestep::FixedTimestep(float stepHz, int maxSubsteps)
+    : step(1.0f / stepHz),
+      maxSubsteps(std::max(1, maxSubsteps)),
+      accumulator(0.0f),
+      droppedTime(0.0f) {}
+
+int FixedTimestep::Advance(float frameTime) {
+    if (frameTime > 0.0f) {
+        accumulator += frameTime;
+    }
+
+    int steps = static_cast<int>(accumulator / step);
+    if (steps > maxSubsteps) {
+        // 超出上限：只跑 maxSubsteps 步，剩下的時間丟掉（保留不足一步的餘數）
+        float kept = accumulator - static_cast<float>(steps) * step;
+        droppedTime += static_cast<float>(steps - maxSubsteps) * step;
+        steps = maxSubsteps;
+        accumulator = kept;
+    } else {
+        accumulator -= static_cast<float>(steps) * step;
+    }
+
+    // 浮點誤差可能讓餘數略小於 0
+    accumulator = std::max(accumulator, 0.0f);
+    return steps;
+}
+
+void FixedTimestep::SetRate(float stepHz) {
+    float newStep = 1.0f / std::max(stepHz, 1.0f);
+    // 保持插值位置不跳動
+    accumulator = GetAlpha() * newStep;
+    step = newStep;
+}
+
+void FixedTimestep::SetMaxSubsteps(int substeps) {
+    maxSubsteps = std::max(1, substeps);
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// Fixed-dt accumulator: the render loop feeds it the real frame time and it
+// answers how many simulation steps of exactly GetStep() seconds to run.
+// Whatever is left over (< one step) becomes the interpolation factor used to
+// blend the last two simulation states for drawing.
+class FixedTimestep {
+public:
+    explicit FixedTimestep(float stepHz = 120.0f, int maxSubsteps = 8);
+
+    // Adds frameTime to the accumulator and returns the number of steps to run.
+    // At most maxSubsteps are returned; time beyond that is dropped so one slow
+    // frame cannot snowball into ever longer frames.
+    int Advance(float frameTime);
+
+    void SetRate(float stepHz);
+    void SetMaxSubsteps(int substeps);
+    void Reset() { accumulator = 0.0f; }
+
+    float GetStep() const { return step; }
+    float GetRate() const { return 1.0f / step; }
+    int GetMaxSubsteps() const { return maxSubsteps; }
+    // 0 = last simulated state, 1 = one step ahead of it
+    float GetAlpha() const { return accumulator / step; }
+    // Simulation time thrown away because of the substep cap, since start
+    float GetDroppedTime() const { return droppedTime; }
+
+private:
+    float step;
+    int maxSubsteps;
+    float accumulator;
+    float droppedTime;
+};
@@ -0,0 +1,59 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+FrameArena::FrameArena(size_t initialCapacity)
+    : block(nullptr), capacity(0), offset(0), overflowBytes(0), peak(0) {
+    if (initialCapacity > 0) {
+        block = static_cast<unsigned char*>(::operator new(initialCapacity));
+        capacity = initialCapacity;
+    }
+}
+
+FrameArena::~FrameArena() {
+    for (void* extra : overflow) {
+        ::operator delete(extra);
+    }
+    ::operator delete(block);
+}
+
+void* FrameArena::Allocate(size_t bytes, size_t alignment) {
+    assert(alignment <= alignof(std::max_align_t));
+    size_t start = (offset + alignment - 1) & ~(alignment - 1);
+    if (start + bytes <= capacity) {
+        offset = start + bytes;
+        return block + start;
+    }
+    // Out of room this tick; Reset folds this into the next block size
+    void* extra = ::operator new(std::max<size_t>(bytes, 1));
+    overflow.push_back(extra);
+    overflowBytes += bytes + alignof(std::max_align_t);
+    return extra;
+}
+
+void FrameArena::Reset() {
+    peak = std::max(peak, GetUsed());
+    if (!overflow.empty()) {
+        for (void* extra : overflow) {
+            ::operator delete(extra);
+        }
+        overflow.clear();
+        ::operator delete(block);
+        capacity = peak + peak / 4;
+        block = static_cast<unsigned char*>(::operator new(capacity));
+    }
+    offset = 0;
+    overflowBytes = 0;
+}
+
+void FrameArena::Reserve(size_t bytes) {
+    assert(GetUsed() == 0 && overflow.empty());
+    if (bytes <= capacity) {
+        return;
+    }
+    ::operator delete(block);
+    block = static_cast<unsigned char*>(::operator new(bytes));
+    capacity = bytes;
+}
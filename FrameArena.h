@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Bump allocator for containers that only live for one simulation tick.
+// Allocate just advances an offset and Reset drops everything at once.
+// A tick that needs more than the block holds is served from overflow blocks;
+// the next Reset swaps them all for one block sized to that peak, so once the
+// arena has seen the busiest tick it never touches the heap again.
+// Not thread-safe: allocate from the serial parts of a tick.
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity = 0);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // alignment must not exceed alignof(std::max_align_t)
+    void* Allocate(size_t bytes, size_t alignment);
+    template <typename T>
+    T* Allocate(size_t count) { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+    // Invalidates everything handed out since the last Reset
+    void Reset();
+    // Grows the block to at least bytes up front, for callers that know their
+    // worst tick. Only between ticks: Reset first.
+    void Reserve(size_t bytes);
+
+    size_t GetUsed() const { return offset + overflowBytes; } // bytes since the last Reset
+    size_t GetCapacity() const { return capacity; }
+    size_t GetPeak() const { return peak; }
+
+private:
+    unsigned char* block;
+    size_t capacity;
+    size_t offset;
+    size_t overflowBytes;
+    size_t peak;
+    std::vector<void*> overflow;
+};
@@ -0,0 +1,132 @@
+#include "FuzzyEngine.h"
+#include <algorithm>
+
+FuzzyEngine::FuzzyEngine()
+    : termCount(), ruleCount(0) {}
+
+void FuzzyEngine::SetTerm(int input, int term, const FuzzySet& set) {
+    if (input < 0 || input >= kInputs || term < 0 || term >= kMaxTerms) {
+        return;
+    }
+    terms[input][term] = set;
+    termCount[input] = std::max(termCount[input], term + 1);
+}
+
+void FuzzyEngine::AddRule(int term0, int term1, float output) {
+    if (ruleCount >= kMaxRules) {
+        return;
+    }
+    Rule& rule = rules[ruleCount++];
+    rule.term[0] = static_cast<uint8_t>(term0);
+    rule.term[1] = static_cast<uint8_t>(term1);
+    rule.output = output;
+}
+
+float FuzzyEngine::Evaluate(float input0, float input1) const {
+    float membership[kInputs][kMaxTerms];
+    for (int t = 0; t < termCount[0]; t++) membership[0][t] = terms[0][t].Membership(input0);
+    for (int t = 0; t < termCount[1]; t++) membership[1][t] = terms[1][t].Membership(input1);
+
+    float totalWeight = 0.0f;
+    float weightedSum = 0.0f;
+    for (int r = 0; r < ruleCount; r++) {
+        float weight = membership[0][rules[r].term[0]] * membership[1][rules[r].term[1]];
+        if (weight > 0.0f) {
+            totalWeight += weight;
+            weightedSum += weight * rules[r].output;
+        }
+    }
+    return totalWeight > 0.0f ? weightedSum / totalWeight : 0.0f;
+}
+
+void FuzzyEngine::EvaluateBatch(const float* input0, const float* input1, float* output, size_t count) const {
+    // Blocks keep the per-term scratch on the stack
+    const size_t kBlock = 64;
+    float membership[kInputs][kMaxTerms][kBlock];
+    float totalWeight[kBlock];
+    float weightedSum[kBlock];
+
+    for (size_t base = 0; base < count; base += kBlock) {
+        size_t n = std::min(kBlock, count - base);
+        const float* in[kInputs] = { input0 + base, input1 + base };
+
+        for (int input = 0; input < kInputs; input++) {
+            for (int t = 0; t < termCount[input]; t++) {
+                const FuzzySet set = terms[input][t];
+                float* m = membership[input][t];
+                for (size_t i = 0; i < n; i++) {
+                    float x = in[input][i];
+                    // Same arithmetic as FuzzySet::Membership, as selects
+                    float rising = (x - set.a) / (set.b - set.a);
+                    float falling = (set.d - x) / (set.d - set.c);
+                    float value = x <= set.c ? 1.0f : falling;
+                    value = x < set.b ? rising : value;
+                    bool outside = (x <= set.a) | (x >= set.d); // no short-circuit branch
+                    m[i] = outside ? 0.0f : value;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            totalWeight[i] = 0.0f;
+            weightedSum[i] = 0.0f;
+        }
+        // A rule that does not fire has weight +0, and adding +0 changes
+        // nothing, so the `weight > 0` test of Evaluate can be dropped here
+        for (int r = 0; r < ruleCount; r++) {
+            const float* m0 = membership[0][rules[r].term[0]];
+            const float* m1 = membership[1][rules[r].term[1]];
+            float ruleOutput = rules[r].output;
+            for (size_t i = 0; i < n; i++) {
+                float weight = m0[i] * m1[i];
+                totalWeight[i] += weight;
+                weightedSum[i] += weight * ruleOutput;
+            }
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            // Divide unconditionally (by 1 when nothing fired) so the loop stays branch-free
+            bool fired = totalWeight[i] > 0.0f;
+            float average = weightedSum[i] / (fired ? totalWeight[i] : 1.0f);
+            output[base + i] = fired ? average : 0.0f;
+        }
+    }
+}
+
+namespace PreyPriority {
+
+namespace {
+    FuzzyEngine Build() {
+        const float inf = std::numeric_limits<float>::infinity();
+        FuzzyEngine engine;
+
+        // Distance: Close peaks at 0 and is gone at 3, Medium peaks at 3.5, Far is full from 7
+        engine.SetTerm(kDistance, kClose,          FuzzySet{ -inf, -inf, 0.5f, 3.0f });
+        engine.SetTerm(kDistance, kMediumDistance, FuzzySet{ 1.0f, 3.5f, 3.5f, 6.0f });
+        engine.SetTerm(kDistance, kFar,            FuzzySet{ 4.0f, 7.0f, inf, inf });
+
+        // Prey value (5 / 10 / 15 points)
+        engine.SetTerm(kValue, kLow,         FuzzySet{ -inf, -inf, 5.0f, 10.0f });
+        engine.SetTerm(kValue, kMediumValue, FuzzySet{ 5.0f, 10.0f, 10.0f, 15.0f });
+        engine.SetTerm(kValue, kHigh,        FuzzySet{ 10.0f, 15.0f, inf, inf });
+
+        // Output priorities: VeryHigh 0.9, High 0.7, Medium 0.5, Low 0.3, VeryLow 0.1
+        engine.AddRule(kClose,          kHigh,        0.9f);
+        engine.AddRule(kClose,          kMediumValue, 0.7f);
+        engine.AddRule(kMediumDistance, kHigh,        0.7f);
+        engine.AddRule(kFar,            kHigh,        0.5f);
+        engine.AddRule(kClose,          kLow,         0.5f);
+        engine.AddRule(kMediumDistance, kMediumValue, 0.5f);
+        engine.AddRule(kMediumDistance, kLow,         0.3f);
+        engine.AddRule(kFar,            kMediumValue, 0.3f);
+        engine.AddRule(kFar,            kLow,         0.1f);
+        return engine;
+    }
+}
+
+const FuzzyEngine& Engine() {
+    static const FuzzyEngine engine = Build();
+    return engine;
+}
+
+} // namespace PreyPriority
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Trapezoid membership set {a, b, c, d}: 0 outside (a, d), rising on [a, b),
+// 1 on [b, c], falling on (c, d). Triangles have b == c; shoulders put a and b
+// (or c and d) at -/+infinity.
+struct FuzzySet {
+    float a, b, c, d;
+
+    float Membership(float x) const {
+        if (x <= a || x >= d) return 0.0f;
+        if (x < b) return (x - a) / (b - a);
+        if (x <= c) return 1.0f;
+        return (d - x) / (d - c);
+    }
+};
+
+// Two-input Sugeno-style engine: every rule is
+//   IF input0 is term0 AND input1 is term1 THEN output
+// with AND as the product and a weighted average of the rule outputs as the
+// crisp result (0 when no rule fires). Terms are addressed by index, rules are
+// data, and evaluation does no allocation or string work.
+class FuzzyEngine {
+public:
+    static const int kInputs = 2;
+    static const int kMaxTerms = 4; // per input
+    static const int kMaxRules = 16;
+
+    FuzzyEngine();
+
+    void SetTerm(int input, int term, const FuzzySet& set);
+    // Rules fire in the order they were added
+    void AddRule(int term0, int term1, float output);
+
+    float Evaluate(float input0, float input1) const;
+    // Scores `count` candidates at once. Branch-free over the candidates, so the
+    // loops vectorise; gives exactly the same values as Evaluate.
+    void EvaluateBatch(const float* input0, const float* input1, float* output, size_t count) const;
+
+private:
+    struct Rule {
+        uint8_t term[kInputs];
+        float output;
+    };
+
+    FuzzySet terms[kInputs][kMaxTerms];
+    int termCount[kInputs];
+    Rule rules[kMaxRules];
+    int ruleCount;
+};
+
+// The purple predator's prey priority: input 0 is the distance, input 1 the prey's point value
+namespace PreyPriority {
+    enum Input { kDistance = 0, kValue = 1 };
+    enum DistanceTerm { kClose = 0, kMediumDistance, kFar };
+    enum ValueTerm { kLow = 0, kMediumValue, kHigh };
+
+    const FuzzyEngine& Engine();
+}
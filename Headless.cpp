@@ -0,0 +1,298 @@
+// Headless runner: steps the simulation with a fixed dt and no window / GL context.
+//
+// Usage: 3DRenderHeadless [--ticks N] [--balls N] [--seed S] [--dt SECONDS] [--threads N] [--check-allocs] [--discrete] [--no-sleep]
+//                         [--simd scalar|sse2|avx2] [--threat-cell SIZE] [--ai-budget N] [--record FILE]
+//                         [--load-snapshot FILE] [--save-snapshot FILE]
+//        3DRenderHeadless --replay FILE [--threads N]
+//
+// --check-allocs fails (exit code 2) if any step after the warm-up allocates from the heap.
+// --discrete turns off the swept (continuous) collision pass for comparison.
+// --no-sleep keeps resting prey awake, to compare against the sleeping path.
+// --simd forces the instruction set of the vectorised kernels (see SimdLevel.h)
+// instead of the best one the CPU supports; every level must end in the same state hash.
+// --threat-cell sets the node spacing of the threat field prey avoid predators by (see ThreatField.h).
+// --ai-budget caps the predator target selections per tick (see AiScheduler.h); 0 = unlimited.
+// --record writes the run as an input recording (see InputRecording.h).
+// --load-snapshot starts from a saved world instead of spawning (--balls / --seed are
+// ignored); --save-snapshot writes the world after the last tick (see WorldSnapshot.h).
+// --replay re-runs a recording (from here or from the app) as fast as possible and
+// checks the state hash after every tick; exit code 3 on the first mismatch, 1 if
+// the recording cannot be read or is corrupt.
+#include <glm/glm.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "AABB.h"
+#include "AllocationCounter.h"
+#include "InputRecording.h"
+#include "SimdLevel.h"
+#include "Simulation.h"
+#include "WorldSnapshot.h"
+
+namespace {
+
+// Steps allowed to grow the pools and the frame arena before --check-allocs counts
+const int kAllocWarmupTicks = 120;
+
+struct Options {
+    int ticks = 10000;
+    int balls = 30;
+    unsigned int seed = 1;
+    float dt = 1.0f / 60.0f;
+    int threads = 1;
+    bool checkAllocs = false;
+    bool discrete = false;
+    bool noSleep = false;
+    bool forceSimd = false;
+    SimdLevel simd = SimdLevel::Scalar;
+    float threatCellSize = BallWorld::kThreatCellSize;
+    int aiBudget = 0;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* loadSnapshotPath = nullptr;
+    const char* saveSnapshotPath = nullptr;
+};
+
+void PrintUsage(const char* exe) {
+    printf("Usage: %s [--ticks N] [--balls N] [--seed S] [--dt SECONDS] [--threads N] [--check-allocs] [--discrete] [--no-sleep]\n"
+           "       %*s [--simd scalar|sse2|avx2] [--threat-cell SIZE] [--ai-budget N] [--record FILE]\n"
+           "       %*s [--load-snapshot FILE] [--save-snapshot FILE]\n"
+           "       %s --replay FILE [--threads N]\n",
+           exe, static_cast<int>(strlen(exe)), "", static_cast<int>(strlen(exe)), "", exe);
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (strcmp(arg, "--ticks") == 0 && hasValue) {
+            options.ticks = atoi(argv[++i]);
+        } else if (strcmp(arg, "--balls") == 0 && hasValue) {
+            options.balls = atoi(argv[++i]);
+        } else if (strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+        } else if (strcmp(arg, "--dt") == 0 && hasValue) {
+            options.dt = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(arg, "--threads") == 0 && hasValue) {
+            options.threads = atoi(argv[++i]);
+        } else if (strcmp(arg, "--check-allocs") == 0) {
+            options.checkAllocs = true;
+        } else if (strcmp(arg, "--discrete") == 0) {
+            options.discrete = true;
+        } else if (strcmp(arg, "--no-sleep") == 0) {
+            options.noSleep = true;
+        } else if (strcmp(arg, "--simd") == 0 && hasValue) {
+            const char* name = argv[++i];
+            options.forceSimd = true;
+            if (strcmp(name, "scalar") == 0) {
+                options.simd = SimdLevel::Scalar;
+            } else if (strcmp(name, "sse2") == 0) {
+                options.simd = SimdLevel::Sse2;
+            } else if (strcmp(name, "avx2") == 0) {
+                options.simd = SimdLevel::Avx2;
+            } else {
+                return false;
+            }
+        } else if (strcmp(arg, "--threat-cell") == 0 && hasValue) {
+            options.threatCellSize = static_cast<float>(atof(argv[++i]));
+        } else if (strcmp(arg, "--ai-budget") == 0 && hasValue) {
+            options.aiBudget = atoi(argv[++i]);
+        } else if (strcmp(arg, "--record") == 0 && hasValue) {
+            options.recordPath = argv[++i];
+        } else if (strcmp(arg, "--replay") == 0 && hasValue) {
+            options.replayPath = argv[++i];
+        } else if (strcmp(arg, "--load-snapshot") == 0 && hasValue) {
+            options.loadSnapshotPath = argv[++i];
+        } else if (strcmp(arg, "--save-snapshot") == 0 && hasValue) {
+            options.saveSnapshotPath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    // A recording replays from a fresh spawn, so it cannot start from a snapshot
+    bool recordFromSnapshot = options.recordPath && options.loadSnapshotPath;
+    return options.ticks >= 0 && options.balls >= 0 && options.dt > 0.0f && options.threads >= 1 &&
+           options.threatCellSize > 0.0f && options.aiBudget >= 0 && !recordFromSnapshot;
+}
+
+// Same room as main.cpp
+AABB MakeRoom() {
+    float x = 7.2f, y = 6.3f, z = 4.8f;
+    return AABB(glm::vec3(x - 10.0f, y - 10.0f, z - 10.0f), glm::vec3(x, y, z));
+}
+
+int Replay(const Options& options) {
+    InputPlayer player;
+    if (!player.Open(options.replayPath)) {
+        printf("Cannot read recording %s\n", options.replayPath);
+        return 1;
+    }
+    const RecordingHeader& header = player.GetHeader();
+    Simulation simulation(MakeRoom());
+    simulation.SetThreadCount(options.threads);
+    simulation.SetGravity(header.gravity);
+    simulation.SetPredatorSpeed(header.predatorSpeed);
+    simulation.SetContinuousCollision(header.continuousCollision);
+    simulation.SetSleeping(header.sleeping);
+    simulation.SetThreatCellSize(header.threatCellSize);
+    simulation.SetAiBudget(header.aiBudget);
+    simulation.SetAiFocus(header.aiFocus);
+    simulation.Reserve(header.ballCount);
+    simulation.Restart(header.seed, header.ballCount);
+
+    std::vector<InputEvent> events;
+    float dt = 0.0f;
+    uint64_t recordedHash = 0;
+    int ticks = 0;
+    int inputs = 0;
+    double simulatedSeconds = 0.0;
+    auto start = std::chrono::high_resolution_clock::now();
+    while (player.NextTick(events, dt, recordedHash)) {
+        for (const InputEvent& input : events) {
+            ApplyInput(simulation, input);
+        }
+        inputs += static_cast<int>(events.size());
+        simulation.Step(dt);
+        simulatedSeconds += dt;
+        uint64_t hash = simulation.StateHash();
+        if (hash != recordedHash) {
+            printf("Replay diverged at tick %d: state hash %016llx, recorded %016llx\n", ticks,
+                   static_cast<unsigned long long>(hash), static_cast<unsigned long long>(recordedHash));
+            return 3;
+        }
+        ticks++;
+    }
+    if (player.IsCorrupt()) {
+        printf("Recording %s is corrupt after tick %d\n", options.replayPath, ticks);
+        return 1;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    printf("Replayed %s: seed %llu, %d balls, %d ticks (%.1f simulated s), %d inputs, %d threads\n",
+           options.replayPath, static_cast<unsigned long long>(header.seed), header.ballCount,
+           ticks, simulatedSeconds, inputs, options.threads);
+    printf("Every tick matched the recorded state hash\n");
+    printf("Time: %.3f ms total, %.1fx realtime\n", totalMs,
+           totalMs > 0.0 ? simulatedSeconds * 1000.0 / totalMs : 0.0);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+    if (options.forceSimd) {
+        if (!Simd::IsSupported(options.simd)) {
+            printf("This CPU does not support %s\n", Simd::Name(options.simd));
+            return 1;
+        }
+        Simd::SetLevel(options.simd);
+    }
+    if (options.replayPath) {
+        return Replay(options);
+    }
+
+    Simulation simulation(MakeRoom());
+    simulation.SetThreadCount(options.threads);
+    simulation.SetContinuousCollision(!options.discrete);
+    simulation.SetSleeping(!options.noSleep);
+    simulation.SetThreatCellSize(options.threatCellSize);
+    simulation.SetAiBudget(options.aiBudget);
+    if (options.loadSnapshotPath) {
+        auto loadStart = std::chrono::high_resolution_clock::now();
+        if (!WorldSnapshot::Load(options.loadSnapshotPath, simulation)) {
+            printf("Cannot load snapshot %s\n", options.loadSnapshotPath);
+            return 1;
+        }
+        double loadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - loadStart).count();
+        options.balls = static_cast<int>(simulation.GetWorld().Size());
+        options.seed = static_cast<unsigned int>(simulation.GetSeed());
+        printf("Loaded snapshot %s in %.3f ms: %d balls at tick %u\n",
+               options.loadSnapshotPath, loadMs, options.balls, simulation.GetTick());
+    } else {
+        simulation.Reserve(options.balls);
+        simulation.Restart(options.seed, options.balls);
+    }
+
+    InputRecorder recorder;
+    if (options.recordPath) {
+        RecordingHeader header = { options.seed, options.balls, simulation.GetGravity(), simulation.GetPredatorSpeed(),
+                                   simulation.GetContinuousCollision(), simulation.GetSleeping(),
+                                   simulation.GetThreatCellSize(), simulation.GetAiBudget(), simulation.GetAiFocus() };
+        if (!recorder.Open(options.recordPath, header)) {
+            printf("Cannot write recording %s\n", options.recordPath);
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    uint64_t warmAllocations = AllocationCounter::GetCount();
+    for (int tick = 0; tick < options.ticks; tick++) {
+        if (tick == kAllocWarmupTicks) {
+            warmAllocations = AllocationCounter::GetCount();
+        }
+        simulation.Step(options.dt);
+        if (recorder.IsOpen()) {
+            recorder.EndTick(options.dt, simulation.StateHash());
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    uint64_t tickAllocations = options.ticks > kAllocWarmupTicks ? AllocationCounter::GetCount() - warmAllocations : 0;
+    double totalMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+    printf("seed %u, %d balls, %d ticks @ dt %.5f s (%.1f simulated s), %d threads, %s kernels\n",
+           options.seed, options.balls, options.ticks, options.dt, options.ticks * options.dt, options.threads,
+           Simd::Name(Simd::GetLevel()));
+
+    int preyLeft = 0;
+    BallWorld& world = simulation.GetWorld();
+    for (size_t i = 0; i < world.Size(); i++) {
+        DrawBall ball = world.Ball(i);
+        if (!ball.IsPredator()) {
+            preyLeft++;
+            continue;
+        }
+        glm::vec3 color = ball.GetColor();
+        bool isGrayPredator = (color.r > 0.4f && color.g > 0.4f && color.b > 0.4f);
+        printf("%s Score: %d\n", isGrayPredator ? "Grey Predator (FSM)" : "Purple Predator (Fuzzy)", ball.GetScore());
+    }
+    printf("Prey left: %d (%zu asleep)\n", preyLeft, world.CountAsleep());
+    printf("State hash: %016llx\n", static_cast<unsigned long long>(simulation.StateHash()));
+
+    double ticksPerSecond = totalMs > 0.0 ? options.ticks / (totalMs / 1000.0) : 0.0;
+    printf("Time: %.3f ms total, %.4f ms/tick, %.0f ticks/s\n",
+           totalMs, options.ticks > 0 ? totalMs / options.ticks : 0.0, ticksPerSecond);
+    if (options.saveSnapshotPath) {
+        auto saveStart = std::chrono::high_resolution_clock::now();
+        if (!WorldSnapshot::Save(options.saveSnapshotPath, simulation)) {
+            printf("Cannot write snapshot %s\n", options.saveSnapshotPath);
+            return 1;
+        }
+        double saveMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - saveStart).count();
+        printf("Saved snapshot %s in %.3f ms\n", options.saveSnapshotPath, saveMs);
+    }
+    if (recorder.IsOpen()) {
+        recorder.Close();
+        printf("Recorded %u ticks (%llu bytes) to %s\n", recorder.GetTickCount(),
+               static_cast<unsigned long long>(recorder.GetBytesWritten()), options.recordPath);
+    }
+
+    if (options.checkAllocs) {
+        if (options.ticks <= kAllocWarmupTicks) {
+            printf("Heap allocations: not checked, needs more than %d ticks\n", kAllocWarmupTicks);
+            return 2;
+        }
+        printf("Heap allocations after %d warm-up ticks: %llu\n",
+               kAllocWarmupTicks, static_cast<unsigned long long>(tickAllocations));
+        if (tickAllocations != 0) {
+            return 2;
+        }
+    }
+    return 0;
+}
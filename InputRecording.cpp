@@ -0,0 +1,221 @@
+#include "InputRecording.h"
+#include "Simulation.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+const char kMagic[4] = { 'B', 'W', 'R', 'C' };
+const uint32_t kVersion = 3;
+
+// Float events carry value, the rest count; either way 4 bytes on disk
+bool HasFloatPayload(InputType type) {
+    return type == InputType::SetGravity || type == InputType::SetPredatorSpeed ||
+           type == InputType::SetThreatCellSize;
+}
+
+// Prey the handle slots can hold next to the two predators Restart spawns
+bool ValidBallCount(int32_t count) {
+    return count >= 0 && count <= static_cast<int32_t>(BallWorld::kMaxSlots) - 2;
+}
+
+// What the app and the headless runner can record; anything else is a
+// corrupt file, not an input to apply
+bool ValidEvent(const InputEvent& input) {
+    switch (input.type) {
+    case InputType::SetBallCount:
+        return ValidBallCount(input.count);
+    case InputType::SetGravity:
+    case InputType::SetPredatorSpeed:
+    case InputType::SetThreatCellSize:
+        return std::isfinite(input.value);
+    case InputType::ResetBalls:
+    case InputType::SetAiFocus:
+        return true;
+    case InputType::SetContinuousCollision:
+    case InputType::SetSleeping:
+        return input.count == 0 || input.count == 1;
+    case InputType::SetAiBudget:
+        return input.count >= 0;
+    }
+    return false;
+}
+
+} // namespace
+
+void ApplyInput(Simulation& simulation, const InputEvent& input) {
+    switch (input.type) {
+    case InputType::SetBallCount:
+        simulation.InitializeBalls(input.count);
+        break;
+    case InputType::SetGravity:
+        simulation.SetGravity(input.value);
+        break;
+    case InputType::SetPredatorSpeed:
+        simulation.SetPredatorSpeed(input.value);
+        break;
+    case InputType::ResetBalls:
+        simulation.ResetBalls();
+        break;
+    case InputType::SetContinuousCollision:
+        simulation.SetContinuousCollision(input.count != 0);
+        break;
+    case InputType::SetSleeping:
+        simulation.SetSleeping(input.count != 0);
+        break;
+    case InputType::SetThreatCellSize:
+        simulation.SetThreatCellSize(input.value);
+        break;
+    case InputType::SetAiBudget:
+        simulation.SetAiBudget(input.count);
+        break;
+    case InputType::SetAiFocus:
+        simulation.SetAiFocus(UnpackAiFocus(input.count));
+        break;
+    }
+}
+
+int32_t PackAiFocus(const glm::vec2& focusXZ) {
+    int32_t x = static_cast<int32_t>(std::lround(glm::clamp(focusXZ.x * 100.0f, -32768.0f, 32767.0f)));
+    int32_t z = static_cast<int32_t>(std::lround(glm::clamp(focusXZ.y * 100.0f, -32768.0f, 32767.0f)));
+    return static_cast<int32_t>((static_cast<uint32_t>(x) << 16) | (static_cast<uint32_t>(z) & 0xFFFFu));
+}
+
+glm::vec2 UnpackAiFocus(int32_t packed) {
+    int16_t x = static_cast<int16_t>(static_cast<uint32_t>(packed) >> 16);
+    int16_t z = static_cast<int16_t>(static_cast<uint32_t>(packed) & 0xFFFFu);
+    return glm::vec2(x * 0.01f, z * 0.01f);
+}
+
+bool InputRecorder::Open(const std::string& path, const RecordingHeader& header) {
+    Close();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    pending.clear();
+    tickCount = 0;
+    bytesWritten = 0;
+
+    uint8_t continuous = header.continuousCollision ? 1 : 0;
+    uint8_t sleeping = header.sleeping ? 1 : 0;
+    Write(kMagic, sizeof(kMagic));
+    Write(&kVersion, sizeof(kVersion));
+    Write(&header.seed, sizeof(header.seed));
+    Write(&header.ballCount, sizeof(header.ballCount));
+    Write(&header.gravity, sizeof(header.gravity));
+    Write(&header.predatorSpeed, sizeof(header.predatorSpeed));
+    Write(&continuous, sizeof(continuous));
+    Write(&sleeping, sizeof(sleeping));
+    Write(&header.threatCellSize, sizeof(header.threatCellSize));
+    Write(&header.aiBudget, sizeof(header.aiBudget));
+    Write(&header.aiFocus.x, sizeof(header.aiFocus.x));
+    Write(&header.aiFocus.y, sizeof(header.aiFocus.y));
+    return static_cast<bool>(file);
+}
+
+void InputRecorder::Close() {
+    if (file.is_open()) {
+        file.close();
+    }
+}
+
+void InputRecorder::AddEvent(const InputEvent& input) {
+    if (IsOpen()) {
+        pending.push_back(input);
+    }
+}
+
+void InputRecorder::EndTick(float deltaTime, uint64_t stateHash) {
+    if (!IsOpen()) {
+        return;
+    }
+    // Input changes arrive at frame rate, a handful per tick at most
+    uint16_t eventCount = static_cast<uint16_t>(pending.size());
+    Write(&eventCount, sizeof(eventCount));
+    for (uint16_t e = 0; e < eventCount; e++) {
+        const InputEvent& input = pending[e];
+        Write(&input.type, sizeof(input.type));
+        if (HasFloatPayload(input.type)) {
+            Write(&input.value, sizeof(input.value));
+        } else {
+            Write(&input.count, sizeof(input.count));
+        }
+    }
+    pending.clear();
+    Write(&deltaTime, sizeof(deltaTime));
+    Write(&stateHash, sizeof(stateHash));
+    tickCount++;
+}
+
+void InputRecorder::Write(const void* data, size_t size) {
+    file.write(static_cast<const char*>(data), size);
+    bytesWritten += size;
+}
+
+bool InputPlayer::Open(const std::string& path) {
+    file.open(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    char magic[4];
+    uint32_t version = 0;
+    uint8_t continuous = 0, sleeping = 0;
+    bool ok = Read(magic, sizeof(magic)) && memcmp(magic, kMagic, sizeof(kMagic)) == 0 &&
+              Read(&version, sizeof(version)) && version == kVersion &&
+              Read(&header.seed, sizeof(header.seed)) &&
+              Read(&header.ballCount, sizeof(header.ballCount)) &&
+              Read(&header.gravity, sizeof(header.gravity)) &&
+              Read(&header.predatorSpeed, sizeof(header.predatorSpeed)) &&
+              Read(&continuous, sizeof(continuous)) &&
+              Read(&sleeping, sizeof(sleeping)) &&
+              Read(&header.threatCellSize, sizeof(header.threatCellSize)) &&
+              Read(&header.aiBudget, sizeof(header.aiBudget)) &&
+              Read(&header.aiFocus.x, sizeof(header.aiFocus.x)) &&
+              Read(&header.aiFocus.y, sizeof(header.aiFocus.y));
+    ok = ok && ValidBallCount(header.ballCount) && std::isfinite(header.gravity) &&
+         std::isfinite(header.predatorSpeed) && continuous <= 1 && sleeping <= 1 &&
+         std::isfinite(header.threatCellSize) && header.aiBudget >= 0 &&
+         std::isfinite(header.aiFocus.x) && std::isfinite(header.aiFocus.y);
+    header.continuousCollision = continuous != 0;
+    header.sleeping = sleeping != 0;
+    corrupt = !ok;
+    return ok;
+}
+
+bool InputPlayer::NextTick(std::vector<InputEvent>& events, float& deltaTime, uint64_t& stateHash) {
+    events.clear();
+    if (corrupt) {
+        return false;
+    }
+    uint16_t eventCount = 0;
+    if (!Read(&eventCount, sizeof(eventCount))) {
+        // Ending between two ticks is the end of the recording, anywhere else it was cut off
+        corrupt = file.gcount() != 0;
+        return false;
+    }
+    corrupt = true;
+    for (uint16_t e = 0; e < eventCount; e++) {
+        InputEvent input = {};
+        if (!Read(&input.type, sizeof(input.type))) {
+            return false;
+        }
+        bool ok = HasFloatPayload(input.type) ? Read(&input.value, sizeof(input.value))
+                                              : Read(&input.count, sizeof(input.count));
+        if (!ok || !ValidEvent(input)) {
+            return false;
+        }
+        events.push_back(input);
+    }
+    if (!Read(&deltaTime, sizeof(deltaTime)) || !Read(&stateHash, sizeof(stateHash)) ||
+        !std::isfinite(deltaTime) || !(deltaTime > 0.0f)) {
+        return false;
+    }
+    corrupt = false;
+    return true;
+}
+
+bool InputPlayer::Read(void* data, size_t size) {
+    file.read(static_cast<char*>(data), size);
+    return static_cast<bool>(file);
+}
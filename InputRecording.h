@@ -0,0 +1,106 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class Simulation;
+
+// Everything outside the simulation that changes its result. The app routes
+// its controls through ApplyInput so a recording can replay them.
+enum class InputType : uint8_t {
+    SetBallCount,           // count: InitializeBalls
+    SetGravity,             // value
+    SetPredatorSpeed,       // value
+    ResetBalls,
+    SetContinuousCollision, // count: 0 / 1
+    SetSleeping,            // count: 0 / 1
+    SetThreatCellSize,      // value
+    SetAiBudget,            // count: selections per tick, 0 = unlimited
+    SetAiFocus,             // count: PackAiFocus
+};
+
+struct InputEvent {
+    InputType type;
+    float value;
+    int32_t count;
+};
+
+void ApplyInput(Simulation& simulation, const InputEvent& input);
+
+// The AI focus (camera XZ) in whole centimetres, X in the high 16 bits, so a
+// SetAiFocus event keeps the 4-byte payload; the room is far inside +-327 m
+int32_t PackAiFocus(const glm::vec2& focusXZ);
+glm::vec2 UnpackAiFocus(int32_t packed);
+
+// Settings a recording starts from; Simulation::Restart(seed, ballCount)
+// after applying them reproduces the first tick
+struct RecordingHeader {
+    uint64_t seed;
+    int32_t ballCount;
+    float gravity;
+    float predatorSpeed;
+    bool continuousCollision;
+    bool sleeping;
+    float threatCellSize;
+    int32_t aiBudget;
+    glm::vec2 aiFocus;
+};
+
+// Recording layout (little-endian, no padding):
+//   header: "BWRC", u32 version, u64 seed, i32 balls, f32 gravity,
+//           f32 predator speed, u8 continuous collision, u8 sleeping,
+//           f32 threat cell size, i32 AI budget, f32 AI focus x, f32 AI focus z
+//   per tick: u16 event count, events (u8 type + 4-byte payload),
+//             f32 dt, u64 StateHash after the step
+// Events are applied before the tick's step, in order.
+class InputRecorder {
+public:
+    InputRecorder() : tickCount(0), bytesWritten(0) {}
+
+    // Writes the header; false if the file cannot be created
+    bool Open(const std::string& path, const RecordingHeader& header);
+    void Close();
+    bool IsOpen() const { return file.is_open(); }
+
+    // Queued for the next EndTick
+    void AddEvent(const InputEvent& input);
+    void EndTick(float deltaTime, uint64_t stateHash);
+
+    uint32_t GetTickCount() const { return tickCount; }
+    uint64_t GetBytesWritten() const { return bytesWritten; }
+
+private:
+    void Write(const void* data, size_t size);
+
+    std::ofstream file;
+    std::vector<InputEvent> pending;
+    uint32_t tickCount;
+    uint64_t bytesWritten;
+};
+
+class InputPlayer {
+public:
+    InputPlayer() : header(), corrupt(false) {}
+
+    // Reads the header; false if the file is missing, not a recording, or
+    // holds settings no run can have (ball count past the handle slots,
+    // non-finite values)
+    bool Open(const std::string& path);
+    const RecordingHeader& GetHeader() const { return header; }
+
+    // The next tick's events, dt and recorded hash; false at the end of the
+    // file, and also for a tick that is cut off, has an unknown event type or
+    // an out-of-range payload, or a dt that is not finite and positive.
+    // IsCorrupt tells the two apart; once corrupt, no further tick is read.
+    bool NextTick(std::vector<InputEvent>& events, float& deltaTime, uint64_t& stateHash);
+    bool IsCorrupt() const { return corrupt; }
+
+private:
+    bool Read(void* data, size_t size);
+
+    std::ifstream file;
+    RecordingHeader header;
+    bool corrupt;
+};
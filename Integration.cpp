@@ -0,0 +1,179 @@
+#include "Integration.h"
+#include "BallWorld.h"
+#include <cstring>
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Everything the kernels read, hoisted out of the loop
+struct Room {
+    float minX, minY, minZ;
+    float maxX, maxY, maxZ;
+};
+
+void IntegrateScalar(BallWorld& world, size_t begin, size_t end, float deltaTime, const Room& room) {
+    for (size_t i = begin; i < end; i++) {
+        if (world.flags[i] & BallWorld::kStationary) continue;
+        float scale = world.radius[i];
+
+        world.velY[i] += world.gravity[i] * deltaTime;
+        world.posX[i] += world.velX[i] * deltaTime;
+        world.posY[i] += world.velY[i] * deltaTime;
+        world.posZ[i] += world.velZ[i] * deltaTime;
+
+        // The floor clamps: balls rest on it, and a mirrored floor would make them hop
+        if (world.posY[i] - scale < room.minY) {
+            world.posY[i] = room.minY + scale;
+            world.velY[i] *= -1.0f;
+        }
+        // Walls mirror the overshoot back instead of clamping it away, so
+        // a fast ball keeps the distance it travelled after the impact
+        AABB::ReflectInside(world.posX[i], world.velX[i], room.minX + scale, room.maxX - scale);
+        AABB::ReflectInside(world.posZ[i], world.velZ[i], room.minZ + scale, room.maxZ - scale);
+    }
+}
+
+#ifdef SIMD_X86
+
+// Select(mask, a, b) = mask ? a : b, lane by lane
+inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// AABB::ReflectInside without branches. Below wins over above like its
+// if / else if; max(lo, p) and min(hi, p) return p on ties like glm::clamp.
+inline void ReflectInside(__m128& position, __m128& velocity, __m128 lo, __m128 hi, __m128 signBit) {
+    __m128 two = _mm_set1_ps(2.0f);
+    __m128 below = _mm_cmplt_ps(position, lo);
+    __m128 above = _mm_cmpgt_ps(position, hi);
+    __m128 mirrored = Select(above, _mm_sub_ps(_mm_mul_ps(two, hi), position), position);
+    mirrored = Select(below, _mm_sub_ps(_mm_mul_ps(two, lo), position), mirrored);
+    velocity = _mm_xor_ps(velocity, _mm_and_ps(_mm_or_ps(below, above), signBit));
+    position = _mm_min_ps(hi, _mm_max_ps(lo, mirrored));
+}
+
+void IntegrateSse2(BallWorld& world, size_t begin, size_t end, float deltaTime, const Room& room) {
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 minX = _mm_set1_ps(room.minX), maxX = _mm_set1_ps(room.maxX);
+    const __m128 minY = _mm_set1_ps(room.minY);
+    const __m128 minZ = _mm_set1_ps(room.minZ), maxZ = _mm_set1_ps(room.maxZ);
+    const __m128i stationary = _mm_set1_epi32(BallWorld::kStationary);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        // Four flag bytes widened to 32-bit lanes; asleep lanes keep their old values
+        int32_t flagBytes;
+        memcpy(&flagBytes, &world.flags[i], sizeof(flagBytes));
+        __m128i flags = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(flagBytes), _mm_setzero_si128()),
+                                           _mm_setzero_si128());
+        __m128 asleep = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(flags, stationary), stationary));
+
+        __m128 scale = _mm_loadu_ps(&world.radius[i]);
+        __m128 px0 = _mm_loadu_ps(&world.posX[i]), py0 = _mm_loadu_ps(&world.posY[i]), pz0 = _mm_loadu_ps(&world.posZ[i]);
+        __m128 vx0 = _mm_loadu_ps(&world.velX[i]), vy0 = _mm_loadu_ps(&world.velY[i]), vz0 = _mm_loadu_ps(&world.velZ[i]);
+
+        __m128 vx = vx0, vz = vz0;
+        __m128 vy = _mm_add_ps(vy0, _mm_mul_ps(_mm_loadu_ps(&world.gravity[i]), dt));
+        __m128 px = _mm_add_ps(px0, _mm_mul_ps(vx, dt));
+        __m128 py = _mm_add_ps(py0, _mm_mul_ps(vy, dt));
+        __m128 pz = _mm_add_ps(pz0, _mm_mul_ps(vz, dt));
+
+        __m128 onFloor = _mm_cmplt_ps(_mm_sub_ps(py, scale), minY);
+        py = Select(onFloor, _mm_add_ps(minY, scale), py);
+        vy = _mm_xor_ps(vy, _mm_and_ps(onFloor, signBit));
+        ReflectInside(px, vx, _mm_add_ps(minX, scale), _mm_sub_ps(maxX, scale), signBit);
+        ReflectInside(pz, vz, _mm_add_ps(minZ, scale), _mm_sub_ps(maxZ, scale), signBit);
+
+        _mm_storeu_ps(&world.posX[i], Select(asleep, px0, px));
+        _mm_storeu_ps(&world.posY[i], Select(asleep, py0, py));
+        _mm_storeu_ps(&world.posZ[i], Select(asleep, pz0, pz));
+        _mm_storeu_ps(&world.velX[i], Select(asleep, vx0, vx));
+        _mm_storeu_ps(&world.velY[i], Select(asleep, vy0, vy));
+        _mm_storeu_ps(&world.velZ[i], Select(asleep, vz0, vz));
+    }
+    IntegrateScalar(world, i, end, deltaTime, room);
+}
+
+SIMD_TARGET_AVX2 inline void ReflectInside(__m256& position, __m256& velocity, __m256 lo, __m256 hi, __m256 signBit) {
+    __m256 two = _mm256_set1_ps(2.0f);
+    __m256 below = _mm256_cmp_ps(position, lo, _CMP_LT_OQ);
+    __m256 above = _mm256_cmp_ps(position, hi, _CMP_GT_OQ);
+    __m256 mirrored = _mm256_blendv_ps(position, _mm256_sub_ps(_mm256_mul_ps(two, hi), position), above);
+    mirrored = _mm256_blendv_ps(mirrored, _mm256_sub_ps(_mm256_mul_ps(two, lo), position), below);
+    velocity = _mm256_xor_ps(velocity, _mm256_and_ps(_mm256_or_ps(below, above), signBit));
+    position = _mm256_min_ps(hi, _mm256_max_ps(lo, mirrored));
+}
+
+SIMD_TARGET_AVX2 void IntegrateAvx2(BallWorld& world, size_t begin, size_t end, float deltaTime, const Room& room) {
+    const __m256 dt = _mm256_set1_ps(deltaTime);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256 minX = _mm256_set1_ps(room.minX), maxX = _mm256_set1_ps(room.maxX);
+    const __m256 minY = _mm256_set1_ps(room.minY);
+    const __m256 minZ = _mm256_set1_ps(room.minZ), maxZ = _mm256_set1_ps(room.maxZ);
+    const __m256i stationary = _mm256_set1_epi32(BallWorld::kStationary);
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256i flags = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&world.flags[i])));
+        __m256 asleep = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(flags, stationary), stationary));
+
+        __m256 scale = _mm256_loadu_ps(&world.radius[i]);
+        __m256 px0 = _mm256_loadu_ps(&world.posX[i]), py0 = _mm256_loadu_ps(&world.posY[i]), pz0 = _mm256_loadu_ps(&world.posZ[i]);
+        __m256 vx0 = _mm256_loadu_ps(&world.velX[i]), vy0 = _mm256_loadu_ps(&world.velY[i]), vz0 = _mm256_loadu_ps(&world.velZ[i]);
+
+        __m256 vx = vx0, vz = vz0;
+        __m256 vy = _mm256_add_ps(vy0, _mm256_mul_ps(_mm256_loadu_ps(&world.gravity[i]), dt));
+        __m256 px = _mm256_add_ps(px0, _mm256_mul_ps(vx, dt));
+        __m256 py = _mm256_add_ps(py0, _mm256_mul_ps(vy, dt));
+        __m256 pz = _mm256_add_ps(pz0, _mm256_mul_ps(vz, dt));
+
+        __m256 onFloor = _mm256_cmp_ps(_mm256_sub_ps(py, scale), minY, _CMP_LT_OQ);
+        py = _mm256_blendv_ps(py, _mm256_add_ps(minY, scale), onFloor);
+        vy = _mm256_xor_ps(vy, _mm256_and_ps(onFloor, signBit));
+        ReflectInside(px, vx, _mm256_add_ps(minX, scale), _mm256_sub_ps(maxX, scale), signBit);
+        ReflectInside(pz, vz, _mm256_add_ps(minZ, scale), _mm256_sub_ps(maxZ, scale), signBit);
+
+        _mm256_storeu_ps(&world.posX[i], _mm256_blendv_ps(px, px0, asleep));
+        _mm256_storeu_ps(&world.posY[i], _mm256_blendv_ps(py, py0, asleep));
+        _mm256_storeu_ps(&world.posZ[i], _mm256_blendv_ps(pz, pz0, asleep));
+        _mm256_storeu_ps(&world.velX[i], _mm256_blendv_ps(vx, vx0, asleep));
+        _mm256_storeu_ps(&world.velY[i], _mm256_blendv_ps(vy, vy0, asleep));
+        _mm256_storeu_ps(&world.velZ[i], _mm256_blendv_ps(vz, vz0, asleep));
+    }
+    IntegrateScalar(world, i, end, deltaTime, room);
+}
+
+#endif // SIMD_X86
+
+} // namespace
+
+namespace Integration {
+
+void Integrate(BallWorld& world, size_t begin, size_t end, float deltaTime, const AABB& roomAABB) {
+    Integrate(Simd::GetLevel(), world, begin, end, deltaTime, roomAABB);
+}
+
+void Integrate(SimdLevel level, BallWorld& world, size_t begin, size_t end, float deltaTime, const AABB& roomAABB) {
+    glm::vec3 roomMin = roomAABB.GetMin();
+    glm::vec3 roomMax = roomAABB.GetMax();
+    Room room = { roomMin.x, roomMin.y, roomMin.z, roomMax.x, roomMax.y, roomMax.z };
+    switch (level) {
+#ifdef SIMD_X86
+    case SimdLevel::Avx2:
+        IntegrateAvx2(world, begin, end, deltaTime, room);
+        return;
+    case SimdLevel::Sse2:
+        IntegrateSse2(world, begin, end, deltaTime, room);
+        return;
+#endif
+    default:
+        IntegrateScalar(world, begin, end, deltaTime, room);
+        return;
+    }
+}
+
+} // namespace Integration
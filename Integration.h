@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include "AABB.h"
+#include "SimdLevel.h"
+
+class BallWorld;
+
+// Gravity, position integration and the floor / wall bounce for a range of
+// balls, straight over BallWorld's SoA arrays. Sleeping balls are left as they are.
+//
+// One kernel per SimdLevel: a scalar loop, SSE2 (4 balls per instruction)
+// and AVX2 (8). The vector ones replace the branches with compare masks and
+// selects in the same arithmetic order, so results are bit-identical to the
+// scalar loop and a run replays the same on machines with and without AVX2.
+namespace Integration {
+
+// Integrates balls [begin, end) over deltaTime inside roomAABB, at Simd::GetLevel()
+void Integrate(BallWorld& world, size_t begin, size_t end, float deltaTime, const AABB& roomAABB);
+void Integrate(SimdLevel level, BallWorld& world, size_t begin, size_t end, float deltaTime, const AABB& roomAABB);
+
+} // namespace Integration
@@ -0,0 +1,81 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+JobSystem::JobSystem(int threadCount)
+    : generation(0),
+      busyWorkers(0),
+      stopping(false),
+      jobFn(nullptr),
+      jobContext(nullptr),
+      jobCount(0),
+      jobGrain(1),
+      nextItem(0) {
+    int workerCount = std::max(threadCount, 1) - 1;
+    workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(&JobSystem::WorkerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::Run(size_t count, size_t grain, RangeFn fn, const void* context) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobFn = fn;
+        jobContext = context;
+        jobCount = count;
+        jobGrain = grain;
+        nextItem.store(0, std::memory_order_relaxed);
+        busyWorkers = workers.size();
+        generation++;
+    }
+    wakeCondition.notify_all();
+
+    // 呼叫端也一起分擔工作
+    DrainChunks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+}
+
+void JobSystem::WorkerLoop() {
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        DrainChunks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            doneCondition.notify_one();
+        }
+    }
+}
+
+void JobSystem::DrainChunks() {
+    for (;;) {
+        size_t begin = nextItem.fetch_add(jobGrain, std::memory_order_relaxed);
+        if (begin >= jobCount) {
+            return;
+        }
+        size_t end = std::min(begin + jobGrain, jobCount);
+        jobFn(jobContext, begin, end);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Minimal fork-join thread pool. ParallelFor splits [0, count) into chunks of
+// `grain` items; the worker threads and the calling thread pull chunks until
+// none are left, then the call returns. The body must only write the items of
+// its own range, so the result does not depend on how chunks land on threads.
+class JobSystem {
+public:
+    // threadCount includes the calling thread; 1 runs everything inline
+    explicit JobSystem(int threadCount = 1);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    int GetThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // body(begin, end) is called for disjoint ranges covering [0, count)
+    template <typename Body>
+    void ParallelFor(size_t count, size_t grain, const Body& body) {
+        if (grain == 0) grain = 1;
+        if (workers.empty() || count <= grain) {
+            if (count > 0) body(0, count);
+            return;
+        }
+        Run(count, grain, &Invoke<Body>, &body);
+    }
+
+private:
+    using RangeFn = void (*)(const void* context, size_t begin, size_t end);
+
+    template <typename Body>
+    static void Invoke(const void* context, size_t begin, size_t end) {
+        (*static_cast<const Body*>(context))(begin, end);
+    }
+
+    void Run(size_t count, size_t grain, RangeFn fn, const void* context);
+    void WorkerLoop();
+    void DrainChunks();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    uint64_t generation;  // bumped once per ParallelFor
+    size_t busyWorkers;   // workers that have not finished the current job
+    bool stopping;
+
+    // Current job, written under the mutex before generation is bumped
+    RangeFn jobFn;
+    const void* jobContext;
+    size_t jobCount;
+    size_t jobGrain;
+    std::atomic<size_t> nextItem;
+};
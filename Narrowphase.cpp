@@ -0,0 +1,171 @@
+#include "Narrowphase.h"
+#include "BallWorld.h"
+#include <cmath>
+
+#ifdef SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Pairs with squaredDistance >= radiusSum^2 * kRejectSlack are certainly apart.
+// The slack covers the rounding of radiusSum^2, so the square-root test that
+// follows decides every remaining pair exactly like glm::length did.
+const float kRejectSlack = 1.000001f;
+
+using Narrowphase::Contact;
+
+struct Arrays {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* radius;
+};
+
+Arrays WorldArrays(const BallWorld& world) {
+    return { world.posX.data(), world.posY.data(), world.posZ.data(), world.radius.data() };
+}
+
+size_t FindContactsScalar(const Arrays& world, const uint32_t* pairA, const uint32_t* pairB, size_t count,
+                          Contact* contacts) {
+    size_t written = 0;
+    for (size_t k = 0; k < count; k++) {
+        uint32_t a = pairA[k];
+        uint32_t b = pairB[k];
+        glm::vec3 delta(world.x[b] - world.x[a], world.y[b] - world.y[a], world.z[b] - world.z[a]);
+        float squaredDistance = delta.x * delta.x + delta.y * delta.y + delta.z * delta.z;
+        float radiusSum = world.radius[a] + world.radius[b];
+        if (squaredDistance >= radiusSum * radiusSum * kRejectSlack) {
+            continue;
+        }
+        float distance = std::sqrt(squaredDistance);
+        if (!(distance < radiusSum)) {
+            continue;
+        }
+        glm::vec3 normal = distance < Narrowphase::kMinDistance ? glm::vec3(0.0f) : delta / distance;
+        contacts[written++] = { a, b, normal, radiusSum - distance };
+    }
+    return written;
+}
+
+#ifdef SIMD_X86
+
+// Writes the lanes set in hitBits, lowest first, from the lane arrays. Every
+// lane is stored and only the hits advance the cursor, so there is no branch
+// per lane to mispredict; the stores stay inside contacts because the cursor
+// never passes the index of the pair being written.
+inline size_t Compact(unsigned hitBits, int lanes, const uint32_t* pairA, const uint32_t* pairB, const float* normalX,
+                      const float* normalY, const float* normalZ, const float* depth, Contact* contacts) {
+    size_t written = 0;
+    for (int lane = 0; lane < lanes; lane++) {
+        contacts[written] = { pairA[lane], pairB[lane], glm::vec3(normalX[lane], normalY[lane], normalZ[lane]),
+                              depth[lane] };
+        written += (hitBits >> lane) & 1u;
+    }
+    return written;
+}
+
+size_t FindContactsSse2(const Arrays& world, const uint32_t* pairA, const uint32_t* pairB, size_t count,
+                        Contact* contacts) {
+    const __m128 slack = _mm_set1_ps(kRejectSlack);
+    const __m128 minDistance = _mm_set1_ps(Narrowphase::kMinDistance);
+    size_t written = 0;
+    size_t k = 0;
+    for (; k + 4 <= count; k += 4) {
+        // No gather before AVX2: the lanes are filled one load at a time
+        const uint32_t* a = pairA + k;
+        const uint32_t* b = pairB + k;
+        __m128 dx = _mm_sub_ps(_mm_setr_ps(world.x[b[0]], world.x[b[1]], world.x[b[2]], world.x[b[3]]),
+                               _mm_setr_ps(world.x[a[0]], world.x[a[1]], world.x[a[2]], world.x[a[3]]));
+        __m128 dy = _mm_sub_ps(_mm_setr_ps(world.y[b[0]], world.y[b[1]], world.y[b[2]], world.y[b[3]]),
+                               _mm_setr_ps(world.y[a[0]], world.y[a[1]], world.y[a[2]], world.y[a[3]]));
+        __m128 dz = _mm_sub_ps(_mm_setr_ps(world.z[b[0]], world.z[b[1]], world.z[b[2]], world.z[b[3]]),
+                               _mm_setr_ps(world.z[a[0]], world.z[a[1]], world.z[a[2]], world.z[a[3]]));
+        __m128 radiusSum = _mm_add_ps(
+            _mm_setr_ps(world.radius[a[0]], world.radius[a[1]], world.radius[a[2]], world.radius[a[3]]),
+            _mm_setr_ps(world.radius[b[0]], world.radius[b[1]], world.radius[b[2]], world.radius[b[3]]));
+        __m128 squaredDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        __m128 near = _mm_cmplt_ps(squaredDistance, _mm_mul_ps(_mm_mul_ps(radiusSum, radiusSum), slack));
+        if (_mm_movemask_ps(near) == 0) {
+            continue;
+        }
+        __m128 distance = _mm_sqrt_ps(squaredDistance);
+        unsigned hitBits = static_cast<unsigned>(_mm_movemask_ps(_mm_and_ps(near, _mm_cmplt_ps(distance, radiusSum))));
+        if (hitBits == 0) {
+            continue;
+        }
+        __m128 usable = _mm_cmpge_ps(distance, minDistance);
+        alignas(16) float normalX[4], normalY[4], normalZ[4], depth[4];
+        _mm_store_ps(normalX, _mm_and_ps(usable, _mm_div_ps(dx, distance)));
+        _mm_store_ps(normalY, _mm_and_ps(usable, _mm_div_ps(dy, distance)));
+        _mm_store_ps(normalZ, _mm_and_ps(usable, _mm_div_ps(dz, distance)));
+        _mm_store_ps(depth, _mm_sub_ps(radiusSum, distance));
+        written += Compact(hitBits, 4, a, b, normalX, normalY, normalZ, depth, contacts + written);
+    }
+    return written + FindContactsScalar(world, pairA + k, pairB + k, count - k, contacts + written);
+}
+
+SIMD_TARGET_AVX2 size_t FindContactsAvx2(const Arrays& world, const uint32_t* pairA, const uint32_t* pairB,
+                                          size_t count, Contact* contacts) {
+    const __m256 slack = _mm256_set1_ps(kRejectSlack);
+    const __m256 minDistance = _mm256_set1_ps(Narrowphase::kMinDistance);
+    size_t written = 0;
+    size_t k = 0;
+    for (; k + 8 <= count; k += 8) {
+        // Ball indices stay below 2^20, so they are valid signed gather offsets
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairA + k));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairB + k));
+        __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(world.x, b, 4), _mm256_i32gather_ps(world.x, a, 4));
+        __m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(world.y, b, 4), _mm256_i32gather_ps(world.y, a, 4));
+        __m256 dz = _mm256_sub_ps(_mm256_i32gather_ps(world.z, b, 4), _mm256_i32gather_ps(world.z, a, 4));
+        __m256 radiusSum = _mm256_add_ps(_mm256_i32gather_ps(world.radius, a, 4), _mm256_i32gather_ps(world.radius, b, 4));
+        __m256 squaredDistance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                                               _mm256_mul_ps(dz, dz));
+        __m256 near = _mm256_cmp_ps(squaredDistance, _mm256_mul_ps(_mm256_mul_ps(radiusSum, radiusSum), slack), _CMP_LT_OQ);
+        if (_mm256_movemask_ps(near) == 0) {
+            continue;
+        }
+        __m256 distance = _mm256_sqrt_ps(squaredDistance);
+        unsigned hitBits = static_cast<unsigned>(
+            _mm256_movemask_ps(_mm256_and_ps(near, _mm256_cmp_ps(distance, radiusSum, _CMP_LT_OQ))));
+        if (hitBits == 0) {
+            continue;
+        }
+        __m256 usable = _mm256_cmp_ps(distance, minDistance, _CMP_GE_OQ);
+        alignas(32) float normalX[8], normalY[8], normalZ[8], depth[8];
+        _mm256_store_ps(normalX, _mm256_and_ps(usable, _mm256_div_ps(dx, distance)));
+        _mm256_store_ps(normalY, _mm256_and_ps(usable, _mm256_div_ps(dy, distance)));
+        _mm256_store_ps(normalZ, _mm256_and_ps(usable, _mm256_div_ps(dz, distance)));
+        _mm256_store_ps(depth, _mm256_sub_ps(radiusSum, distance));
+        written += Compact(hitBits, 8, pairA + k, pairB + k, normalX, normalY, normalZ, depth, contacts + written);
+    }
+    return written + FindContactsScalar(world, pairA + k, pairB + k, count - k, contacts + written);
+}
+
+#endif // SIMD_X86
+
+} // namespace
+
+namespace Narrowphase {
+
+size_t FindContacts(const BallWorld& world, const uint32_t* pairA, const uint32_t* pairB, size_t count,
+                    Contact* contacts) {
+    return FindContacts(Simd::GetLevel(), world, pairA, pairB, count, contacts);
+}
+
+size_t FindContacts(SimdLevel level, const BallWorld& world, const uint32_t* pairA, const uint32_t* pairB,
+                    size_t count, Contact* contacts) {
+    Arrays arrays = WorldArrays(world);
+    switch (level) {
+#ifdef SIMD_X86
+    case SimdLevel::Avx2:
+        return FindContactsAvx2(arrays, pairA, pairB, count, contacts);
+    case SimdLevel::Sse2:
+        return FindContactsSse2(arrays, pairA, pairB, count, contacts);
+#endif
+    default:
+        return FindContactsScalar(arrays, pairA, pairB, count, contacts);
+    }
+}
+
+} // namespace Narrowphase
@@ -0,0 +1,37 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include "SimdLevel.h"
+
+class BallWorld;
+
+// Exact sphere-sphere test for the candidate pairs the broadphase found.
+//
+// Pairs come packed in two index arrays. The kernels test 8 (AVX2) or 4 (SSE2)
+// pairs per instruction, rejecting on squared distance first, so a square root
+// is only taken for pairs that are close. The pairs that overlap are written out
+// compacted, in input order, with the normal and depth the resolver needs.
+// A pair counts as overlapping exactly when glm::length(b - a) < radius sum,
+// the same test (and bit-identical normal and depth) as the scalar code had.
+namespace Narrowphase {
+
+// Closer centres than this give no usable normal (the resolver then picks a
+// direction itself); such contacts carry a zero normal
+constexpr float kMinDistance = 0.0001f;
+
+struct Contact {
+    uint32_t a;
+    uint32_t b;
+    glm::vec3 normal; // unit vector from a to b, or zero, see kMinDistance
+    float depth;      // radius sum minus centre distance, > 0
+};
+
+// Tests pairs (pairA[k], pairB[k]) for k < count and writes the overlapping
+// ones to contacts (room for count); returns how many were written
+size_t FindContacts(const BallWorld& world, const uint32_t* pairA, const uint32_t* pairB, size_t count,
+                    Contact* contacts);
+size_t FindContacts(SimdLevel level, const BallWorld& world, const uint32_t* pairA, const uint32_t* pairB,
+                    size_t count, Contact* contacts);
+
+} // namespace Narrowphase
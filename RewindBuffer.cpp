@@ -0,0 +1,357 @@
+#include "RewindBuffer.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+// Everything outside the ball arrays that a restored run needs
+struct Scalars {
+    uint64_t seed;
+    uint32_t tick;
+    float gravity;
+    float predatorSpeed;
+    uint8_t continuousCollision;
+    uint8_t sleeping;
+    uint8_t padding[2];
+    float threatCellSize;
+    int32_t aiBudget;
+    float aiFocus[2];
+};
+
+// A literal run in the XOR stream ends at this many zero bytes in a row;
+// shorter gaps are cheaper to keep inside the literal than to encode
+const size_t kMinZeroRun = 4;
+
+// A keyframe group is cut short once it holds this fraction of the budget, so
+// that with large worlds eviction drops a slice of history rather than all of it
+const size_t kMinGroups = 4;
+
+void AppendSegment(std::vector<uint8_t>& image, const void* data, uint32_t bytes) {
+    size_t at = image.size();
+    image.resize(at + sizeof(bytes) + bytes);
+    memcpy(image.data() + at, &bytes, sizeof(bytes));
+    if (bytes > 0) {
+        memcpy(image.data() + at + sizeof(bytes), data, bytes);
+    }
+}
+
+// Walks the (u32 length, bytes) segments of an image; an exhausted or empty
+// image yields empty segments, which is how a keyframe is a delta against nothing
+struct SegmentReader {
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+
+    explicit SegmentReader(const std::vector<uint8_t>& image) : data(image.data()), size(image.size()), position(0) {}
+
+    const uint8_t* Next(uint32_t& bytes) {
+        if (position + sizeof(bytes) > size) {
+            bytes = 0;
+            return nullptr;
+        }
+        memcpy(&bytes, data + position, sizeof(bytes));
+        const uint8_t* segment = data + position + sizeof(bytes);
+        position += sizeof(bytes) + bytes;
+        return segment;
+    }
+};
+
+const size_t kMaxVarintBytes = 10;
+
+uint8_t* WriteVarint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+uint64_t ReadVarint(const uint8_t*& data) {
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+        uint8_t byte = *data++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+}
+
+// Zero XOR bytes from position on
+size_t SkipEqual(const uint8_t* a, const uint8_t* b, size_t position, size_t end) {
+    while (position + 8 <= end) {
+        uint64_t wordA, wordB;
+        memcpy(&wordA, a + position, 8);
+        memcpy(&wordB, b + position, 8);
+        if (wordA != wordB) {
+            break;
+        }
+        position += 8;
+    }
+    while (position < end && a[position] == b[position]) {
+        position++;
+    }
+    return position;
+}
+
+} // namespace
+
+RewindBuffer::RewindBuffer(size_t budgetBytes, uint32_t keyframeInterval)
+    : storage(budgetBytes), head(0), usedBytes(0), keyframeInterval(std::max<uint32_t>(keyframeInterval, 1)),
+      sinceKeyframe(0), groupBytes(0), previousTick(0), previousValid(false),
+      lastCaptureMs(0.0), totalCaptureMs(0.0), captureCount(0), lastFrameBytes(0) {}
+
+void RewindBuffer::SetBudget(size_t budgetBytes) {
+    Clear();
+    storage.assign(budgetBytes, 0);
+    storage.shrink_to_fit();
+}
+
+void RewindBuffer::Clear() {
+    frames.clear();
+    head = 0;
+    usedBytes = 0;
+    sinceKeyframe = 0;
+    groupBytes = 0;
+    previousValid = false;
+    totalCaptureMs = 0.0;
+    captureCount = 0;
+}
+
+size_t RewindBuffer::GetKeyframeCount() const {
+    size_t keyframes = 0;
+    for (const Frame& frame : frames) {
+        keyframes += frame.keyframe;
+    }
+    return keyframes;
+}
+
+void RewindBuffer::Serialize(const Simulation& simulation, std::vector<uint8_t>& image) {
+    Scalars scalars = {};
+    scalars.seed = simulation.GetSeed();
+    scalars.tick = simulation.GetTick();
+    scalars.gravity = simulation.GetGravity();
+    scalars.predatorSpeed = simulation.GetPredatorSpeed();
+    scalars.continuousCollision = simulation.GetContinuousCollision() ? 1 : 0;
+    scalars.sleeping = simulation.GetSleeping() ? 1 : 0;
+    scalars.threatCellSize = simulation.GetThreatCellSize();
+    scalars.aiBudget = simulation.GetAiBudget();
+    scalars.aiFocus[0] = simulation.GetAiFocus().x;
+    scalars.aiFocus[1] = simulation.GetAiFocus().y;
+
+    image.clear();
+    AppendSegment(image, &scalars, sizeof(scalars));
+    simulation.GetWorld().ForEachStateArray([&image](const auto& values) {
+        using Element = typename std::decay_t<decltype(values)>::value_type;
+        AppendSegment(image, values.data(), static_cast<uint32_t>(values.size() * sizeof(Element)));
+    });
+}
+
+void RewindBuffer::Apply(const std::vector<uint8_t>& image, Simulation& simulation) {
+    SegmentReader reader(image);
+    uint32_t bytes = 0;
+    Scalars scalars;
+    memcpy(&scalars, reader.Next(bytes), sizeof(scalars));
+    // Settings first: SetGravity / SetSleeping also touch the ball arrays,
+    // which are overwritten right after
+    simulation.SetSeed(scalars.seed);
+    simulation.SetTick(scalars.tick);
+    simulation.SetGravity(scalars.gravity);
+    simulation.SetPredatorSpeed(scalars.predatorSpeed);
+    simulation.SetContinuousCollision(scalars.continuousCollision != 0);
+    simulation.SetSleeping(scalars.sleeping != 0);
+    simulation.SetThreatCellSize(scalars.threatCellSize);
+    simulation.SetAiBudget(scalars.aiBudget);
+    simulation.SetAiFocus(glm::vec2(scalars.aiFocus[0], scalars.aiFocus[1]));
+    simulation.GetWorld().ForEachStateArray([&reader](auto& values) {
+        using Element = typename std::decay_t<decltype(values)>::value_type;
+        uint32_t segmentBytes = 0;
+        const uint8_t* segment = reader.Next(segmentBytes);
+        values.resize(segmentBytes / sizeof(Element));
+        if (segmentBytes > 0) {
+            memcpy(static_cast<void*>(values.data()), segment, segmentBytes);
+        }
+    });
+}
+
+// Per segment: varint length, then over the bytes both images have
+// (varint zero run, varint literal length, literal XOR bytes) tokens, then
+// the bytes past the end of base verbatim
+size_t RewindBuffer::Encode(const std::vector<uint8_t>& image, const std::vector<uint8_t>& base, std::vector<uint8_t>& out) {
+    size_t length = 0;
+    SegmentReader imageReader(image);
+    SegmentReader baseReader(base);
+    while (imageReader.position < imageReader.size) {
+        uint32_t bytes = 0, baseBytes = 0;
+        const uint8_t* a = imageReader.Next(bytes);
+        const uint8_t* b = baseReader.Next(baseBytes);
+        // Every token after the first spans at least as many bytes as it
+        // encodes to (a literal follows 4+ zeros), so a segment never takes
+        // more than its own bytes plus the length, the first and the last token.
+        // out only grows, so once warmed up the loop writes through a pointer
+        if (out.size() < length + bytes + 4 * kMaxVarintBytes) {
+            out.resize(length + bytes + 4 * kMaxVarintBytes);
+        }
+        uint8_t* write = WriteVarint(out.data() + length, bytes);
+
+        size_t common = std::min(bytes, baseBytes);
+        size_t position = 0;
+        while (position < common) {
+            size_t literalStart = SkipEqual(a, b, position, common);
+            size_t literalEnd = literalStart;
+            for (size_t k = literalStart; k < common && k - literalEnd < kMinZeroRun; k++) {
+                if (a[k] != b[k]) {
+                    literalEnd = k + 1;
+                }
+            }
+            write = WriteVarint(write, literalStart - position);
+            write = WriteVarint(write, literalEnd - literalStart);
+            for (size_t k = literalStart; k < literalEnd; k++) {
+                *write++ = a[k] ^ b[k];
+            }
+            position = literalEnd;
+        }
+        memcpy(write, a + common, bytes - common);
+        write += bytes - common;
+        length = static_cast<size_t>(write - out.data());
+    }
+    return length;
+}
+
+void RewindBuffer::Decode(const uint8_t* data, size_t size, const std::vector<uint8_t>& base, std::vector<uint8_t>& image) {
+    image.clear();
+    SegmentReader baseReader(base);
+    const uint8_t* end = data + size;
+    while (data < end) {
+        uint32_t bytes = static_cast<uint32_t>(ReadVarint(data));
+        uint32_t baseBytes = 0;
+        const uint8_t* b = baseReader.Next(baseBytes);
+
+        size_t at = image.size();
+        image.resize(at + sizeof(bytes) + bytes);
+        memcpy(image.data() + at, &bytes, sizeof(bytes));
+        uint8_t* a = image.data() + at + sizeof(bytes);
+
+        size_t common = std::min(bytes, baseBytes);
+        size_t position = 0;
+        while (position < common) {
+            size_t zeros = static_cast<size_t>(ReadVarint(data));
+            size_t literals = static_cast<size_t>(ReadVarint(data));
+            memcpy(a + position, b + position, zeros);
+            position += zeros;
+            for (size_t k = 0; k < literals; k++, position++) {
+                a[position] = *data++ ^ b[position];
+            }
+        }
+        memcpy(a + common, data, bytes - common);
+        data += bytes - common;
+    }
+}
+
+void RewindBuffer::Capture(const Simulation& simulation) {
+    auto start = std::chrono::high_resolution_clock::now();
+    uint32_t tick = simulation.GetTick();
+    if (!frames.empty() && tick <= frames.back().tick) {
+        DropFrom(tick);
+    }
+
+    Serialize(simulation, current);
+    bool keyframe = frames.empty() || !previousValid || frames.back().tick != previousTick ||
+                    sinceKeyframe + 1 >= keyframeInterval || groupBytes >= storage.size() / kMinGroups;
+    size_t length = Encode(current, keyframe ? empty : previous, encoded);
+    if (!Store(tick, keyframe, encoded.data(), length)) {
+        // Making room evicted the keyframe this delta depends on
+        keyframe = true;
+        length = Encode(current, empty, encoded);
+        Store(tick, keyframe, encoded.data(), length);
+    }
+    sinceKeyframe = keyframe ? 0 : sinceKeyframe + 1;
+    groupBytes = keyframe ? length : groupBytes + length;
+    lastFrameBytes = length;
+
+    std::swap(previous, current);
+    previousTick = tick;
+    previousValid = true;
+
+    lastCaptureMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    totalCaptureMs += lastCaptureMs;
+    captureCount++;
+}
+
+bool RewindBuffer::Store(uint32_t tick, bool keyframe, const uint8_t* data, size_t size) {
+    if (size > storage.size()) {
+        // Not even one keyframe fits the budget: keep no history
+        frames.clear();
+        head = 0;
+        usedBytes = 0;
+        return true;
+    }
+    if (head + size > storage.size()) {
+        head = 0; // the unused tail is skipped
+    }
+    // Writes go round the ring in order, so the bytes ahead of head belong to the oldest frames
+    while (!frames.empty() && frames.front().offset < head + size && head < frames.front().offset + frames.front().size) {
+        EvictOldestGroup();
+    }
+    if (!keyframe && frames.empty()) {
+        return false;
+    }
+    memcpy(storage.data() + head, data, size);
+    frames.push_back({ tick, keyframe, head, size });
+    head += size;
+    usedBytes += size;
+    return true;
+}
+
+void RewindBuffer::EvictOldestGroup() {
+    do {
+        usedBytes -= frames.front().size;
+        frames.pop_front();
+    } while (!frames.empty() && !frames.front().keyframe);
+}
+
+void RewindBuffer::DropFrom(uint32_t tick) {
+    while (!frames.empty() && frames.back().tick >= tick) {
+        usedBytes -= frames.back().size;
+        frames.pop_back();
+    }
+    head = frames.empty() ? 0 : frames.back().offset + frames.back().size;
+    sinceKeyframe = 0;
+    groupBytes = 0;
+    for (size_t i = frames.size(); i-- > 0;) {
+        groupBytes += frames[i].size;
+        if (frames[i].keyframe) {
+            break;
+        }
+        sinceKeyframe++;
+    }
+}
+
+bool RewindBuffer::Restore(uint32_t tick, Simulation& simulation) {
+    auto found = std::lower_bound(frames.begin(), frames.end(), tick,
+                                  [](const Frame& frame, uint32_t value) { return frame.tick < value; });
+    if (found == frames.end() || found->tick != tick) {
+        return false;
+    }
+    size_t target = static_cast<size_t>(found - frames.begin());
+    size_t keyframe = target;
+    while (!frames[keyframe].keyframe) {
+        keyframe--;
+    }
+
+    Decode(storage.data() + frames[keyframe].offset, frames[keyframe].size, empty, current);
+    for (size_t i = keyframe + 1; i <= target; i++) {
+        Decode(storage.data() + frames[i].offset, frames[i].size, current, encoded);
+        std::swap(current, encoded);
+    }
+    Apply(current, simulation);
+
+    previous = current;
+    previousTick = tick;
+    previousValid = true;
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class Simulation;
+
+// Rolling history of the simulation for scrubbing back a few seconds.
+//
+// Each capture serializes the whole state (settings, RNG tick and every
+// BallWorld::ForEachStateArray array) into an image. Every keyframeInterval
+// captures (sooner if the deltas since the last one fill a quarter of the
+// budget) the image is stored whole as a keyframe; in between only its XOR
+// with the previous capture is stored, run-length encoded over zero bytes.
+// Sleeping balls and unchanged fields XOR to zeros.
+//
+// Frames live in one ring of budget bytes. A new frame that does not fit
+// evicts the oldest keyframe together with the deltas that depend on it, so
+// memory never exceeds the budget and history is dropped from the back.
+class RewindBuffer {
+public:
+    explicit RewindBuffer(size_t budgetBytes = 128u << 20, uint32_t keyframeInterval = 120);
+
+    // Both drop the history
+    void SetBudget(size_t budgetBytes);
+    void Clear();
+    size_t GetBudget() const { return storage.size(); }
+
+    // Stores the simulation's state after a Step. Capturing a tick at or
+    // before the newest one (after Restore + resume) first drops the
+    // frames from that tick on, so the timeline forks from there.
+    void Capture(const Simulation& simulation);
+    // Rewinds the simulation to a captured tick; false if the tick is not held.
+    // Decodes from the nearest keyframe at or before it.
+    bool Restore(uint32_t tick, Simulation& simulation);
+
+    bool IsEmpty() const { return frames.empty(); }
+    uint32_t GetOldestTick() const { return frames.empty() ? 0 : frames.front().tick; }
+    uint32_t GetNewestTick() const { return frames.empty() ? 0 : frames.back().tick; }
+    size_t GetFrameCount() const { return frames.size(); }
+    size_t GetKeyframeCount() const;
+    size_t GetUsedBytes() const { return usedBytes; }
+    // Capture cost and size of the last capture, and the average since Clear
+    double GetLastCaptureMs() const { return lastCaptureMs; }
+    double GetAverageCaptureMs() const { return captureCount > 0 ? totalCaptureMs / captureCount : 0.0; }
+    size_t GetLastImageBytes() const { return previous.size(); }
+    size_t GetLastFrameBytes() const { return lastFrameBytes; }
+
+private:
+    struct Frame {
+        uint32_t tick;
+        bool keyframe;
+        size_t offset; // into storage
+        size_t size;
+    };
+
+    static void Serialize(const Simulation& simulation, std::vector<uint8_t>& image);
+    static void Apply(const std::vector<uint8_t>& image, Simulation& simulation);
+    // XOR of image against base (segment by segment), zero runs collapsed;
+    // returns the encoded length, out is only ever grown
+    static size_t Encode(const std::vector<uint8_t>& image, const std::vector<uint8_t>& base, std::vector<uint8_t>& out);
+    static void Decode(const uint8_t* data, size_t size, const std::vector<uint8_t>& base, std::vector<uint8_t>& image);
+
+    // False (nothing stored) if making room evicted the keyframe a delta needs
+    bool Store(uint32_t tick, bool keyframe, const uint8_t* data, size_t size);
+    void EvictOldestGroup();
+    void DropFrom(uint32_t tick);
+
+    std::vector<uint8_t> storage;
+    std::deque<Frame> frames;
+    size_t head;      // next write position in storage
+    size_t usedBytes; // bytes held by frames
+    uint32_t keyframeInterval;
+    uint32_t sinceKeyframe;
+    size_t groupBytes; // stored since the last keyframe, that keyframe included
+
+    // Image of the state the simulation is in as far as the buffer knows:
+    // the last capture, or the last Restore. Deltas are taken against it.
+    std::vector<uint8_t> previous;
+    uint32_t previousTick;
+    bool previousValid;
+
+    // Scratch, reused so a capture does not allocate once warmed up
+    std::vector<uint8_t> current;
+    std::vector<uint8_t> encoded;
+    std::vector<uint8_t> empty;
+
+    double lastCaptureMs;
+    double totalCaptureMs;
+    uint64_t captureCount;
+    size_t lastFrameBytes;
+};
@@ -0,0 +1,62 @@
+#include "SceneUniformBuffer.h"
+#include "Shader.h"
+#include <GL/glew.h>
+#include <cstring>
+
+SceneUniformBuffer::SceneUniformBuffer()
+    : viewUBO(0), frameUBO(0), viewStride(sizeof(ViewBlock)), frame() {}
+
+SceneUniformBuffer::~SceneUniformBuffer() {}
+
+void SceneUniformBuffer::Init(Shader* shader, int viewCount) {
+    shader->BindUniformBlock("ViewData", kViewBinding);
+    shader->BindUniformBlock("FrameData", kFrameBinding);
+
+    GLint alignment = 1;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    if (alignment < 1) alignment = 1;
+    viewStride = (sizeof(ViewBlock) + alignment - 1) / alignment * alignment;
+    viewStaging.assign(viewStride * viewCount, 0);
+
+    glGenBuffers(1, &viewUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, viewUBO);
+    glBufferData(GL_UNIFORM_BUFFER, viewStaging.size(), nullptr, GL_DYNAMIC_DRAW);
+
+    glGenBuffers(1, &frameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameBinding, frameUBO);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void SceneUniformBuffer::Release() {
+    if (viewUBO != 0) {
+        glDeleteBuffers(1, &viewUBO);
+        viewUBO = 0;
+    }
+    if (frameUBO != 0) {
+        glDeleteBuffers(1, &frameUBO);
+        frameUBO = 0;
+    }
+}
+
+void SceneUniformBuffer::SetView(int view, const glm::mat4& viewMat, const glm::mat4& projMat, const glm::vec3& cameraPos) {
+    ViewBlock block;
+    block.viewMat = viewMat;
+    block.projMat = projMat;
+    block.cameraPos = glm::vec4(cameraPos, 1.0f);
+    memcpy(&viewStaging[view * viewStride], &block, sizeof(block));
+}
+
+void SceneUniformBuffer::Upload() {
+    glBindBuffer(GL_UNIFORM_BUFFER, viewUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, viewStaging.size(), viewStaging.data());
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameBlock), &frame);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void SceneUniformBuffer::BindView(int view) const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, kViewBinding, viewUBO, view * viewStride, sizeof(ViewBlock));
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+class Shader;
+
+// std140 uniform blocks shared by the vertex and fragment shader.
+// ViewData (binding 0) holds the camera of one viewport; all viewports live
+// in one buffer and BindView selects a range. FrameData (binding 1) holds the
+// lights, which do not change between viewports. Both are uploaded once per
+// frame, so the draws only set their own per-object uniforms.
+class SceneUniformBuffer {
+public:
+    static const unsigned int kViewBinding = 0;
+    static const unsigned int kFrameBinding = 1;
+
+    // Mirrors `ViewData` in the shaders (std140)
+    struct ViewBlock {
+        glm::mat4 viewMat;
+        glm::mat4 projMat;
+        glm::vec4 cameraPos;
+    };
+
+    // Mirrors `LightSet` in the fragment shader (std140: vec3 padded to vec4)
+    struct LightSet {
+        glm::vec4 ambientColor;
+        glm::vec4 lightPos;
+        glm::vec4 lightColor;
+        glm::vec4 lightPos2;
+        glm::vec4 lightColor2;
+    };
+
+    // Mirrors `FrameData` in the fragment shader
+    struct FrameBlock {
+        LightSet roomLights;
+        LightSet ballLights;
+        int lightEnabled[4]; // ivec4: x = light 1, y = light 2
+    };
+
+    SceneUniformBuffer();
+    ~SceneUniformBuffer();
+
+    // Creates the buffers and binds the shader's blocks to the binding points
+    void Init(Shader* shader, int viewCount);
+    // Needs the GL context, call before glfwTerminate
+    void Release();
+
+    void SetView(int view, const glm::mat4& viewMat, const glm::mat4& projMat, const glm::vec3& cameraPos);
+    FrameBlock& Frame() { return frame; }
+
+    // One glBufferSubData per block for the whole frame
+    void Upload();
+    // Points binding 0 at this viewport's ViewBlock
+    void BindView(int view) const;
+
+private:
+    unsigned int viewUBO;
+    unsigned int frameUBO;
+    size_t viewStride; // sizeof(ViewBlock) rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    std::vector<unsigned char> viewStaging;
+    FrameBlock frame;
+};
+
+static_assert(sizeof(SceneUniformBuffer::ViewBlock) == 144, "ViewBlock must match the std140 layout");
+static_assert(sizeof(SceneUniformBuffer::FrameBlock) == 176, "FrameBlock must match the std140 layout");
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <glm/gtc/type_ptr.hpp>
 
 #include <GL/glew.h>    
 #include <GLFW/glfw3.h> 
@@ -50,6 +51,7 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath){
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
+        reflectUniforms();
         glDeleteShader(vertex);
         glDeleteShader(fragment);
     }
@@ -62,6 +64,109 @@ void Shader::use() {
     glUseProgram(ID);
 }
 
+void Shader::reflectUniforms() {
+    uniforms.clear();
+    uniformLookup.clear();
+
+    GLint linked = 0;
+    glGetProgramiv(ID, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        return;
+    }
+
+    GLint count = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<GLchar> nameBuffer(maxNameLength > 0 ? maxNameLength : 1);
+    for (GLint i = 0; i < count; i++) {
+        UniformInfo info;
+        GLsizei length = 0;
+        glGetActiveUniform(ID, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()),
+                           &length, &info.size, &info.type, nameBuffer.data());
+        info.name.assign(nameBuffer.data(), length);
+        // arrays are reported as "name[0]"; look them up as "name"
+        if (info.name.size() > 3 && info.name.compare(info.name.size() - 3, 3, "[0]") == 0) {
+            info.name.resize(info.name.size() - 3);
+        }
+        info.location = glGetUniformLocation(ID, info.name.c_str());
+        if (info.location < 0) {
+            continue; // uniform block member, set through its buffer instead
+        }
+        uniformLookup[info.name] = static_cast<UniformHandle>(uniforms.size());
+        uniforms.push_back(info);
+    }
+}
+
+void Shader::BindUniformBlock(const char* blockName, unsigned int binding) const {
+    GLuint blockIndex = glGetUniformBlockIndex(ID, blockName);
+    if (blockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(ID, blockIndex, binding);
+    }
+}
+
+UniformHandle Shader::GetUniform(const std::string& name) const {
+    auto it = uniformLookup.find(name);
+    return it == uniformLookup.end() ? -1 : it->second;
+}
+
+bool Shader::checkType(UniformHandle handle, GLenum type) const {
+    if (handle < 0 || handle >= static_cast<UniformHandle>(uniforms.size())) {
+        return false;
+    }
+#ifndef NDEBUG
+    if (uniforms[handle].type != type) {
+        cout << "uniform type mismatch: " << uniforms[handle].name << endl;
+        return false;
+    }
+#endif
+    return true;
+}
+
+void Shader::SetBool(UniformHandle handle, bool value) const {
+    if (checkType(handle, GL_BOOL)) {
+        glUniform1i(uniforms[handle].location, value ? 1 : 0);
+    }
+}
+
+void Shader::SetInt(UniformHandle handle, int value) const {
+    // samplers are set through an int as well
+    bool isSampler = handle >= 0 && handle < static_cast<UniformHandle>(uniforms.size())
+        && uniforms[handle].type == GL_SAMPLER_2D;
+    if (checkType(handle, isSampler ? GL_SAMPLER_2D : GL_INT)) {
+        glUniform1i(uniforms[handle].location, value);
+    }
+}
+
+void Shader::SetFloat(UniformHandle handle, float value) const {
+    if (checkType(handle, GL_FLOAT)) {
+        glUniform1f(uniforms[handle].location, value);
+    }
+}
+
+void Shader::SetVec2(UniformHandle handle, const glm::vec2& value) const {
+    if (checkType(handle, GL_FLOAT_VEC2)) {
+        glUniform2f(uniforms[handle].location, value.x, value.y);
+    }
+}
+
+void Shader::SetVec3(UniformHandle handle, float x, float y, float z) const {
+    if (checkType(handle, GL_FLOAT_VEC3)) {
+        glUniform3f(uniforms[handle].location, x, y, z);
+    }
+}
+
+void Shader::SetVec3(UniformHandle handle, const glm::vec3& value) const {
+    SetVec3(handle, value.x, value.y, value.z);
+}
+
+void Shader::SetMat4(UniformHandle handle, const glm::mat4& value) const {
+    if (checkType(handle, GL_FLOAT_MAT4)) {
+        glUniformMatrix4fv(uniforms[handle].location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+}
+
 void Shader::checkCompileErrors(unsigned int ID, std::string type){
     int success;
     char infoLog[512];
@@ -5,7 +5,14 @@
 
 #include <GL/glew.h>    
 #include <GLFW/glfw3.h> 
+#include <glm/glm.hpp>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+// Index into Shader's uniform table; -1 means the uniform is not active
+// (misspelt or optimised out) and the setters ignore it, like GL does.
+typedef int UniformHandle;
 
 class Shader{
 public:
@@ -16,8 +23,36 @@ public:
     const char* fragmentSource;
     unsigned int ID;
     void use();
+
+    // Points a uniform block at a binding point (GLSL 330 has no layout(binding))
+    void BindUniformBlock(const char* blockName, unsigned int binding) const;
+
+    // Resolve once (e.g. at init), then pass the handle to the setters every frame
+    UniformHandle GetUniform(const std::string& name) const;
+    // Setters act on the program in use
+    void SetBool(UniformHandle handle, bool value) const;
+    void SetInt(UniformHandle handle, int value) const;
+    void SetFloat(UniformHandle handle, float value) const;
+    void SetVec2(UniformHandle handle, const glm::vec2& value) const;
+    void SetVec3(UniformHandle handle, float x, float y, float z) const;
+    void SetVec3(UniformHandle handle, const glm::vec3& value) const;
+    void SetMat4(UniformHandle handle, const glm::mat4& value) const;
+
 private:
+    // One entry per active uniform, filled from the linked program
+    struct UniformInfo {
+        std::string name;
+        GLint location;
+        GLenum type;
+        GLint size;
+    };
+
     void checkCompileErrors(unsigned int ID, std::string type);
+    void reflectUniforms();
+    bool checkType(UniformHandle handle, GLenum type) const;
+
+    std::vector<UniformInfo> uniforms;
+    std::unordered_map<std::string, UniformHandle> uniformLookup;
 };
 
 #endif
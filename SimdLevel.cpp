@@ -0,0 +1,84 @@
+#include "SimdLevel.h"
+#include <atomic>
+
+#if defined(SIMD_X86) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+#ifdef SIMD_X86
+bool CpuHasAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    // AVX needs the OS to save the YMM registers too (OSXSAVE + XCR0 bits 1, 2)
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+SimdLevel BestLevel() {
+    if (Simd::IsSupported(SimdLevel::Avx2)) {
+        return SimdLevel::Avx2;
+    }
+    if (Simd::IsSupported(SimdLevel::Sse2)) {
+        return SimdLevel::Sse2;
+    }
+    return SimdLevel::Scalar;
+}
+
+std::atomic<SimdLevel>& ActiveLevel() {
+    static std::atomic<SimdLevel> level(BestLevel());
+    return level;
+}
+
+} // namespace
+
+namespace Simd {
+
+bool IsSupported(SimdLevel level) {
+    switch (level) {
+#ifdef SIMD_X86
+    case SimdLevel::Avx2: {
+        static const bool hasAvx2 = CpuHasAvx2();
+        return hasAvx2;
+    }
+    case SimdLevel::Sse2:
+        return true; // part of x86-64, and assumed for 32-bit x86 builds too
+#endif
+    case SimdLevel::Scalar:
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char* Name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Avx2: return "AVX2";
+    case SimdLevel::Sse2: return "SSE2";
+    default: return "scalar";
+    }
+}
+
+SimdLevel GetLevel() {
+    return ActiveLevel().load(std::memory_order_relaxed);
+}
+
+void SetLevel(SimdLevel level) {
+    if (IsSupported(level)) {
+        ActiveLevel().store(level, std::memory_order_relaxed);
+    }
+}
+
+} // namespace Simd
@@ -0,0 +1,32 @@
+#pragma once
+
+// Instruction set the hand-vectorised kernels (Integration, Narrowphase) run
+// with. Every level computes bit-identical results; only the speed differs.
+enum class SimdLevel {
+    Scalar,
+    Sse2, // 4 floats per instruction
+    Avx2, // 8 floats per instruction
+};
+
+namespace Simd {
+
+bool IsSupported(SimdLevel level);
+const char* Name(SimdLevel level);
+// The level the kernels use: the best the CPU supports unless SetLevel
+// picked another. SetLevel ignores levels the CPU lacks.
+SimdLevel GetLevel();
+void SetLevel(SimdLevel level);
+
+} // namespace Simd
+
+// For the kernel translation units: SIMD_X86 when SSE2 / AVX2 code can be
+// compiled at all, and the attribute GCC / Clang need on AVX2 functions
+// (MSVC compiles AVX intrinsics anywhere). Callers check IsSupported first.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#endif
+#if defined(SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMD_TARGET_AVX2
+#endif
@@ -0,0 +1,605 @@
+#include "Simulation.h"
+#include <algorithm>
+#include <cmath>
+
+// 一次碰撞解算用到的亂數
+struct CollisionRandoms {
+    float jitter;  // 兩球中心重合時的分離方向
+    float kick[4]; // 兩球的水平速度擾動 (x1, z1, x2, z2)，範圍 [-1, 1]
+};
+
+CollisionRandoms Simulation::DrawCollisionRandoms(uint32_t i, uint32_t j) const {
+    // 由 (tick, 兩顆球的 handle) 決定，與解算順序和執行緒無關
+    CounterRng::Block kicks = rng.Generate(kStreamCollision, tick, world.handle[i], world.handle[j]);
+    CounterRng::Block jitter = rng.Generate(kStreamCollisionJitter, tick, world.handle[i], world.handle[j]);
+    CollisionRandoms randoms;
+    randoms.jitter = CounterRng::ToUnit(jitter.v[0]) - 0.5f;
+    for (int k = 0; k < 4; k++) {
+        randoms.kick[k] = CounterRng::ToSigned(kicks.v[k]);
+    }
+    return randoms;
+}
+
+Simulation::Simulation(const AABB& room)
+    : roomAABB(room),
+      gravityStrength(9.8f),
+      predatorSpeed(5.0f),
+      continuousCollision(true),
+      tick(0),
+      jobs(new JobSystem(1)) {
+    // 沒有攝影機時（無視窗執行）以房間中心為 AI 排程的焦點
+    glm::vec3 center = (room.GetMin() + room.GetMax()) * 0.5f;
+    world.GetAiScheduler().SetFocus(glm::vec2(center.x, center.z));
+}
+
+Simulation::~Simulation() {}
+
+void Simulation::Reserve(int ballCount) {
+    size_t capacity = static_cast<size_t>(ballCount) + 2;
+    world.Reserve(capacity);
+    collisionGrid.Reserve(capacity);
+    contacts.reserve(capacity * kMaxContactsPerBall);
+
+    // 一個 step 從 arena 取用的上限：每顆球的掠食者清單與反查表、AI 排程（到期清單、許可、優先度與排序）、
+    // 要重排計時器的掠食者、掃掠步長與快球清單、睡眠快照、著色遮罩，加上每個接觸的顏色與排序後的接觸、
+    // 一批候選配對；再留對齊的空間
+    size_t perBall = 2 * sizeof(uint32_t) + (2 * sizeof(uint32_t) + sizeof(uint8_t) + sizeof(float)) + sizeof(uint32_t) +
+                     sizeof(float) + sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint64_t);
+    size_t perContact = sizeof(uint8_t) + sizeof(Contact);
+    size_t pairBatch = kPairBatch * (2 * sizeof(uint32_t) + sizeof(Contact));
+    frameArena.Reset();
+    frameArena.Reserve(capacity * perBall + capacity * kMaxContactsPerBall * perContact + pairBatch + 256);
+}
+
+void Simulation::InitializeBalls(int count) {
+    // 只清除 isPredator 為 false 的球
+    for (size_t i = 0; i < world.Size(); i++) {
+        if (!(world.flags[i] & BallWorld::kPredator)) {
+            world.MarkRemoved(i);
+        }
+    }
+    world.RemoveMarked();
+
+    // 獲取房間的邊界
+    glm::vec3 roomMin = roomAABB.GetMin();
+    glm::vec3 roomMax = roomAABB.GetMax();
+
+    // 生成指定數量的非掠食者球（一次配置整批）。
+    // 每顆球的亂數只由自己的 handle 決定，可以分給工作執行緒
+    float scale = 0.1f;
+    size_t first = world.AddBatch(static_cast<size_t>(count), scale);
+    jobs->ParallelFor(static_cast<size_t>(count), BallWorld::kJobGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            DrawBall ball = world.Ball(first + i);
+            CounterRng::Block random = rng.Generate(kStreamSpawn, tick, ball.GetHandle(), 0);
+            float randomVelZ = CounterRng::ToSigned(rng.Generate(kStreamSpawn, tick, ball.GetHandle(), 1).v[0]);
+        
+            // 隨機分配顏色和分數
+            int colorType = random.v[0] % 3;
+            if (colorType == 0) {
+                // 紅球 - 15 points
+                ball.SetColor(glm::vec3(1.0f, 0.0f, 0.0f));
+                ball.SetPoint(15);
+            } else if (colorType == 1) {
+                // 橙球 - 10 points
+                ball.SetColor(glm::vec3(1.0f, 0.5f, 0.0f));
+                ball.SetPoint(10);
+            } else {
+                // 黃球 - 5 points
+                ball.SetColor(glm::vec3(1.0f, 1.0f, 0.0f));
+                ball.SetPoint(5);
+            }
+        
+            float x = roomMin.x + scale + CounterRng::ToUnit(random.v[1]) * (roomMax.x - roomMin.x - 2.0f * scale);
+            float z = roomMin.z + scale + CounterRng::ToUnit(random.v[2]) * (roomMax.z - roomMin.z - 2.0f * scale);
+            float y = roomMin.y + scale;
+            glm::vec3 position(x, y, z);
+
+            ball.SetPosition(position);
+        
+            // 根據分數設定初始速度
+            float speed = 0.0f;
+            if (ball.GetPoint() == 15) speed = 4.0f;      // 紅球
+            else if (ball.GetPoint() == 10) speed = 3.0f; // 橙球
+            else if (ball.GetPoint() == 5) speed = 2.0f;  // 黃球
+        
+            // 隨機方向的水平速度
+            float randomX = CounterRng::ToSigned(random.v[3]) * speed;
+            float randomZ = randomVelZ * speed;
+            ball.SetVelocity(glm::vec3(randomX, 0.0f, randomZ));
+        
+            ball.SetGravity(-gravityStrength);
+            ball.SetIsPredator(false); // 標記為非掠食者
+        }
+    });
+    world.StorePreviousPositions();
+}
+
+void Simulation::SpawnPredators() {
+    // 灰色球
+    float greyBallScale = 0.1f;
+    DrawBall greyBall = world.Add(greyBallScale);
+    greyBall.SetScale(greyBallScale);
+    greyBall.SetPosition(glm::vec3(-2.0f, roomAABB.GetMin().y + 0.1f, -2.0f));
+    greyBall.SetVelocity(glm::vec3(0.0f, 0.0f, 0.0f)); // 掠食者速度為0
+    greyBall.SetColor(glm::vec3(0.5f, 0.5f, 0.5f));
+    greyBall.SetGravity(-gravityStrength);
+    greyBall.SetIsPredator(true); // 設為掠食者
+    greyBall.SetScore(0); // 初始分數為0
+    greyBall.SetPredatorSpeed(predatorSpeed); // 設定掠食者速度
+
+    // 紫色球
+    float purpleBallScale = 0.1f;
+    DrawBall purpleBall = world.Add(purpleBallScale);
+    purpleBall.SetScale(purpleBallScale);
+    purpleBall.SetPosition(glm::vec3(2.0f, roomAABB.GetMin().y + 0.1f, 2.0f));
+    purpleBall.SetVelocity(glm::vec3(0.0f, 0.0f, 0.0f)); // 掠食者速度為0
+    purpleBall.SetColor(glm::vec3(0.5f, 0.0f, 0.5f));
+    purpleBall.SetGravity(-gravityStrength);
+    purpleBall.SetIsPredator(true); // 設為掠食者
+    purpleBall.SetScore(0); // 初始分數為0
+    purpleBall.SetPredatorSpeed(predatorSpeed); // 設定掠食者速度
+    world.StorePreviousPositions();
+}
+
+void Simulation::ResetBalls() {
+    glm::vec3 roomMin = roomAABB.GetMin();
+    glm::vec3 roomMax = roomAABB.GetMax();
+    jobs->ParallelFor(world.Size(), BallWorld::kJobGrain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            DrawBall ball = world.Ball(i);
+            CounterRng::Block random = rng.Generate(kStreamReset, tick, ball.GetHandle());
+            float scale = ball.GetScale();
+            float x = roomMin.x + scale + CounterRng::ToUnit(random.v[0]) * (roomMax.x - roomMin.x - 2.0f * scale);
+            float z = roomMin.z + scale + CounterRng::ToUnit(random.v[1]) * (roomMax.z - roomMin.z - 2.0f * scale);
+            float y = roomMin.y + scale;
+            ball.SetPosition(glm::vec3(x, y, z));
+            // 如果是掠食者，重設分數和AI狀態
+            if (ball.IsPredator()) {
+                ball.SetScore(0);
+                ball.SetVelocity(glm::vec3(0.0f));
+                ball.ResetAIState(); // 重置AI狀態
+            } else {
+                // 重設一般球的速度
+                float speed = 0.0f;
+                if (ball.GetPoint() == 15) speed = 4.0f;      // 紅球
+                else if (ball.GetPoint() == 10) speed = 3.0f; // 橙球
+                else if (ball.GetPoint() == 5) speed = 2.0f;  // 黃球
+
+                float randomX = CounterRng::ToSigned(random.v[2]) * speed;
+                float randomZ = CounterRng::ToSigned(random.v[3]) * speed;
+                ball.SetVelocity(glm::vec3(randomX, 0.0f, randomZ));
+            }
+        }
+    });
+    world.StorePreviousPositions();
+}
+
+void Simulation::Restart(uint64_t seed, int ballCount) {
+    world.Reset();
+    tick = 0;
+    rng.SetSeed(seed);
+    InitializeBalls(ballCount);
+    SpawnPredators();
+}
+
+void Simulation::SetThreadCount(int threads) {
+    threads = std::max(threads, 1);
+    if (threads != jobs->GetThreadCount()) {
+        jobs.reset(new JobSystem(threads));
+    }
+}
+
+void Simulation::SetGravity(float strength) {
+    gravityStrength = strength;
+    std::fill(world.gravity.begin(), world.gravity.end(), -gravityStrength);
+}
+
+void Simulation::SetPredatorSpeed(float speed) {
+    predatorSpeed = speed;
+    // 同步到所有掠食者
+    for (size_t i = 0; i < world.Size(); i++) {
+        if (world.flags[i] & BallWorld::kPredator) {
+            world.predatorSpeed[i] = predatorSpeed;
+        }
+    }
+}
+
+static void ApplyCollisionResponse(DrawBall ball1, DrawBall ball2, const glm::vec3& normal, const CollisionRandoms& randoms);
+static void SeparateAndRespond(DrawBall ball1, DrawBall ball2, const glm::vec3& normal, float overlap,
+                               const CollisionRandoms& randoms);
+
+// 只寫入 ball1 與 ball2，不同球的接觸可以同時解算
+static void ResolveSphereCollision(DrawBall ball1, DrawBall ball2, const CollisionRandoms& randoms) {
+    glm::vec3 pos1 = ball1.GetPosition();
+    glm::vec3 pos2 = ball2.GetPosition();
+    float radius1 = ball1.GetScale();
+    float radius2 = ball2.GetScale();
+
+    glm::vec3 delta = pos2 - pos1;
+    float distance = glm::length(delta);
+
+    if (distance < 0.0001f) {
+        delta = glm::vec3(randoms.jitter);
+        distance = glm::length(delta);
+    }
+
+    float overlap = (radius1 + radius2) - distance;
+
+    if (overlap <= 0) {
+        return;
+    }
+
+
+    glm::vec3 normal = delta / distance;
+    SeparateAndRespond(ball1, ball2, normal, overlap, randoms);
+}
+
+// 接觸產生後兩球都還沒被移動過：直接用 narrowphase 算好的法線與深度，
+// 結果和 ResolveSphereCollision 重新計算的一樣
+static void ResolveSphereContact(DrawBall ball1, DrawBall ball2, const Narrowphase::Contact& contact,
+                                 const CollisionRandoms& randoms) {
+    if (contact.normal == glm::vec3(0.0f)) {
+        ResolveSphereCollision(ball1, ball2, randoms); // 中心幾乎重合，需要隨機方向
+        return;
+    }
+    SeparateAndRespond(ball1, ball2, contact.normal, contact.depth, randoms);
+}
+
+// 沿法線把兩球各推開一半的重疊，再做碰撞反應
+static void SeparateAndRespond(DrawBall ball1, DrawBall ball2, const glm::vec3& normal, float overlap,
+                               const CollisionRandoms& randoms) {
+    glm::vec3 pos1 = ball1.GetPosition();
+    glm::vec3 pos2 = ball2.GetPosition();
+    float correction1 = overlap * 0.5f;
+    float correction2 = overlap * 0.5f;
+
+    ball1.SetPosition(pos1 - normal * correction1);
+    ball2.SetPosition(pos2 + normal * correction2);
+
+    ApplyCollisionResponse(ball1, ball2, normal, randoms);
+}
+
+// 碰撞後沿法線交換速度並加上隨機擾動；normal 由 ball1 指向 ball2
+static void ApplyCollisionResponse(DrawBall ball1, DrawBall ball2, const glm::vec3& normal, const CollisionRandoms& randoms) {
+    float randomFactor = 0.2f;
+    glm::vec3 vel1 = ball1.GetVelocity();
+    glm::vec3 vel2 = ball2.GetVelocity();
+
+    float v1n = glm::dot(vel1, normal);
+    float v2n = glm::dot(vel2, normal);
+
+    if (v1n > v2n) {
+        return;
+    }
+
+    float restitution = 0.6f;
+
+    float v1nAfter = (v1n * (0.0f) + v2n * 2.0f) / 2.0f;
+    float v2nAfter = (v2n * (0.0f) + v1n * 2.0f) / 2.0f;
+
+    v1nAfter = v1n + restitution * (v1nAfter - v1n);
+    v2nAfter = v2n + restitution * (v2nAfter - v2n);
+
+    glm::vec3 v1nVector = normal * v1nAfter;
+    glm::vec3 v2nVector = normal * v2nAfter;
+
+    glm::vec3 v1t = vel1 - (normal * v1n);
+    glm::vec3 v2t = vel2 - (normal * v2n);
+
+    ball1.SetVelocity(v1t + v1nVector);
+    ball2.SetVelocity(v2t + v2nVector);
+
+    // 添加隨機擾動（只有在速度大於閾值時）
+
+    if (glm::length(ball1.GetVelocity()) > 0.05f) {
+        ball1.SetVelocity(ball1.GetVelocity() + glm::vec3(
+            randoms.kick[0] * randomFactor,
+            0.0f,
+            randoms.kick[1] * randomFactor
+        ));
+    }
+    if (glm::length(ball2.GetVelocity()) > 0.05f) {
+        ball2.SetVelocity(ball2.GetVelocity() + glm::vec3(
+            randoms.kick[2] * randomFactor,
+            0.0f,
+            randoms.kick[3] * randomFactor
+        ));
+    }
+
+    // 移除了碰撞後的減速效果
+}
+
+void Simulation::Step(float deltaTime) {
+    frameArena.Reset();
+    world.Update(deltaTime, roomAABB, *jobs, frameArena);
+    ResolveCollisions();
+    tick++;
+}
+
+void Simulation::ResolveCollisions() {
+    // 碰撞檢測和處理
+    // Broadphase：以均勻網格找出候選配對，取代 O(n^2) 的兩兩測試
+    size_t count = world.Size();
+    float maxRadius = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        maxRadius = std::max(maxRadius, world.radius[i]);
+    }
+    collisionGrid.Build(roomAABB, 2.0f * maxRadius, world.posX.data(), world.posY.data(), world.posZ.data(), count);
+
+    // 這一步移動超過自身半徑的球可能穿過別的球，改用連續碰撞（掃掠）處理
+    float* stepLength = nullptr;
+    uint32_t* fastBalls = nullptr;
+    size_t fastCount = 0;
+    if (continuousCollision) {
+        stepLength = frameArena.Allocate<float>(count);
+        fastBalls = frameArena.Allocate<uint32_t>(count);
+        for (size_t i = 0; i < count; i++) {
+            float dx = world.posX[i] - world.prevPosX[i];
+            float dy = world.posY[i] - world.prevPosY[i];
+            float dz = world.posZ[i] - world.prevPosZ[i];
+            stepLength[i] = std::sqrt(dx * dx + dy * dy + dz * dz);
+            if (stepLength[i] > world.radius[i]) {
+                fastBalls[fastCount++] = static_cast<uint32_t>(i);
+            }
+        }
+    }
+
+    // 接觸產生：所有重疊都在同一組位置上找出來。吃掉獵物直接處理，
+    // 球與球的接觸先存起來，之後分批平行解算
+    bool anyEaten = false;
+    contacts.clear();
+    // 兩顆都在睡眠的球不會互相產生配對。先拍下睡眠狀態，
+    // 迴圈中被叫醒的球才不會改變配對的走訪
+    uint8_t* sleeping = frameArena.Allocate<uint8_t>(count);
+    for (size_t i = 0; i < count; i++) {
+        sleeping[i] = world.IsAsleep(i);
+    }
+    auto asleep = [sleeping](uint32_t i) { return sleeping[i] != 0; };
+
+    // 重疊的配對依走訪順序處理
+    size_t maxContacts = kMaxContactsPerBall * count;
+    bool normalsValid = true;
+    auto onContact = [&](const Contact& contact) {
+        uint32_t i = contact.a;
+        uint32_t j = contact.b;
+        // 檢查是否為掠食者與一般球的碰撞
+        bool predator1 = (world.flags[i] & BallWorld::kPredator) != 0;
+        bool predator2 = (world.flags[j] & BallWorld::kPredator) != 0;
+
+        if (predator1 != predator2) {
+            size_t predator = predator1 ? i : j;
+            size_t prey = predator1 ? j : i;
+            // 掠食者吃掉獵物
+            world.score[predator] += world.point[prey];
+            // 標記要移除的球
+            world.MarkRemoved(prey);
+            anyEaten = true;
+            return;
+        }
+        // 被碰到的睡眠球醒來
+        if (world.IsAsleep(i)) world.WakeUp(i);
+        if (world.IsAsleep(j)) world.WakeUp(j);
+        if (contacts.size() < maxContacts) {
+            // 一般的球與球碰撞
+            contacts.push_back(contact);
+        } else {
+            ResolveSphereCollision(world.Ball(i), world.Ball(j), DrawCollisionRandoms(i, j));
+            normalsValid = false;
+        }
+    };
+
+    // Narrowphase：候選配對收集成一批再測試。快滿時（剩下的接觸空間放不下
+    // 整批）改成一對一測試，當場解算的接觸才會像逐對處理時一樣影響後面的配對
+    uint32_t* pairA = frameArena.Allocate<uint32_t>(kPairBatch);
+    uint32_t* pairB = frameArena.Allocate<uint32_t>(kPairBatch);
+    Contact* found = frameArena.Allocate<Contact>(kPairBatch);
+    size_t pending = 0;
+    auto flush = [&]() {
+        size_t foundCount = Narrowphase::FindContacts(world, pairA, pairB, pending, found);
+        pending = 0;
+        for (size_t c = 0; c < foundCount; c++) {
+            onContact(found[c]);
+        }
+    };
+    collisionGrid.ForEachPair([&](uint32_t i, uint32_t j) {
+        if (fastCount > 0 && (IsFast(stepLength, i) || IsFast(stepLength, j))) {
+            return; // 交給下面的掃掠處理
+        }
+        pairA[pending] = i;
+        pairB[pending] = j;
+        pending++;
+        if (pending == kPairBatch || contacts.size() + pending >= maxContacts) {
+            flush();
+        }
+    }, asleep);
+    flush();
+    ResolveContacts(normalsValid);
+
+    for (size_t f = 0; f < fastCount; f++) {
+        anyEaten |= SweepFastBall(fastBalls[f], stepLength, maxRadius);
+    }
+
+    // 移除被吃掉的球
+    if (anyEaten) {
+        world.RemoveMarked();
+    }
+}
+
+void Simulation::ResolveContacts(bool normalsValid) {
+    size_t contactCount = contacts.size();
+    if (contactCount == 0) {
+        return;
+    }
+
+    // 貪婪著色：每個接觸取兩顆球都還沒用過的最小顏色，同色的接觸不共用球。
+    // 用完 kMaxContactColors 種顏色的接觸放進最後一批，逐一解算
+    uint64_t* usedColors = frameArena.Allocate<uint64_t>(world.Size());
+    std::fill(usedColors, usedColors + world.Size(), 0);
+    uint8_t* contactColor = frameArena.Allocate<uint8_t>(contactCount);
+    uint32_t batchStart[kMaxContactColors + 2] = {};
+    for (size_t c = 0; c < contactCount; c++) {
+        uint64_t used = usedColors[contacts[c].a] | usedColors[contacts[c].b];
+        int color = 0;
+        while (color < kMaxContactColors && (used & (1ull << color))) {
+            color++;
+        }
+        if (color < kMaxContactColors) {
+            usedColors[contacts[c].a] |= 1ull << color;
+            usedColors[contacts[c].b] |= 1ull << color;
+        }
+        contactColor[c] = static_cast<uint8_t>(color);
+        batchStart[color + 1]++;
+    }
+    for (int color = 0; color <= kMaxContactColors; color++) {
+        batchStart[color + 1] += batchStart[color];
+    }
+
+    // 依顏色排序（同色內保持接觸順序）
+    Contact* batched = frameArena.Allocate<Contact>(contactCount);
+    uint32_t cursor[kMaxContactColors + 1];
+    std::copy(batchStart, batchStart + kMaxContactColors + 1, cursor);
+    for (size_t c = 0; c < contactCount; c++) {
+        batched[cursor[contactColor[c]]++] = contacts[c];
+    }
+
+    // 一批一批解算；同一批內每個接觸只寫自己的兩顆球，結果與執行緒數無關
+    for (int color = 0; color <= kMaxContactColors; color++) {
+        uint32_t begin = batchStart[color];
+        uint32_t end = batchStart[color + 1];
+        // 兩顆球在這個顏色之前都沒有接觸（遮罩最低位就是這個顏色）時，
+        // 位置還是 narrowphase 看到的樣子，法線和深度可以直接用
+        uint64_t colorBit = color < kMaxContactColors ? 1ull << color : 0;
+        auto firstContact = [&](uint32_t ball) {
+            uint64_t used = usedColors[ball];
+            return (used & (~used + 1)) == colorBit;
+        };
+        auto resolveRange = [&](size_t first, size_t last) {
+            for (size_t k = begin + first; k < begin + last; k++) {
+                const Contact& contact = batched[k];
+                DrawBall ball1 = world.Ball(contact.a);
+                DrawBall ball2 = world.Ball(contact.b);
+                CollisionRandoms randoms = DrawCollisionRandoms(contact.a, contact.b);
+                if (normalsValid && colorBit != 0 && firstContact(contact.a) && firstContact(contact.b)) {
+                    ResolveSphereContact(ball1, ball2, contact, randoms);
+                } else {
+                    ResolveSphereCollision(ball1, ball2, randoms);
+                }
+            }
+        };
+        if (color < kMaxContactColors) {
+            jobs->ParallelFor(end - begin, kContactGrain, resolveRange);
+        } else {
+            resolveRange(0, end - begin);
+        }
+    }
+}
+
+bool Simulation::IsFast(const float* stepLength, uint32_t i) const {
+    return stepLength[i] > world.radius[i];
+}
+
+bool Simulation::SweepFastBall(uint32_t i, const float* stepLength, float maxRadius) {
+    if (world.IsMarkedRemoved(i)) {
+        return false;
+    }
+    glm::vec3 start1(world.prevPosX[i], world.prevPosY[i], world.prevPosZ[i]);
+    glm::vec3 end1(world.posX[i], world.posY[i], world.posZ[i]);
+    float radius1 = world.radius[i];
+    bool predator1 = (world.flags[i] & BallWorld::kPredator) != 0;
+
+    // 候選球：終點離掃掠線段夠近、可能在這一步內碰到的球。兩顆都快的配對由
+    // 移動較多的那顆處理（一樣多時取索引小的），所以對方最多移動 step，
+    // 慢球最多移動自身半徑
+    float step = stepLength[i];
+    glm::vec3 center = (start1 + end1) * 0.5f;
+    float reach = 0.5f * step + 2.0f * maxRadius + std::max(step, maxRadius);
+    auto forEachHit = [&](auto&& onHit) {
+        collisionGrid.ForEachInRadius(center, reach, [&](uint32_t j) {
+            if (j == i || world.IsMarkedRemoved(j)) {
+                return;
+            }
+            if (IsFast(stepLength, j) && (stepLength[j] > step || (stepLength[j] == step && j < i))) {
+                return;
+            }
+            glm::vec3 start2(world.prevPosX[j], world.prevPosY[j], world.prevPosZ[j]);
+            glm::vec3 end2(world.posX[j], world.posY[j], world.posZ[j]);
+            float t;
+            if (AABB::SweptSphereToSphere(start1, end1, radius1, start2, end2, world.radius[j], t)) {
+                onHit(j, t, start2, end2);
+            }
+        });
+    };
+
+    // 第一輪：找最早撞到的非獵物球（同時間取索引小的，與格子走訪順序無關）
+    int bounceBall = -1;
+    float bounceTime = 2.0f;
+    forEachHit([&](uint32_t j, float t, const glm::vec3&, const glm::vec3&) {
+        bool predator2 = (world.flags[j] & BallWorld::kPredator) != 0;
+        if (predator1 == predator2 && (t < bounceTime || (t == bounceTime && static_cast<int>(j) < bounceBall))) {
+            bounceTime = t;
+            bounceBall = static_cast<int>(j);
+        }
+    });
+
+    // 第二輪：反彈之前掃過的獵物都被吃掉（或快速的獵物撞上掠食者）
+    bool anyEaten = false;
+    forEachHit([&](uint32_t j, float t, const glm::vec3&, const glm::vec3&) {
+        bool predator2 = (world.flags[j] & BallWorld::kPredator) != 0;
+        if (predator1 == predator2 || t > bounceTime || world.IsMarkedRemoved(i)) {
+            return;
+        }
+        size_t predator = predator1 ? i : j;
+        size_t prey = predator1 ? j : i;
+        world.score[predator] += world.point[prey];
+        world.MarkRemoved(prey);
+        anyEaten = true;
+    });
+
+    if (bounceBall >= 0 && !world.IsMarkedRemoved(i)) {
+        uint32_t j = static_cast<uint32_t>(bounceBall);
+        glm::vec3 start2(world.prevPosX[j], world.prevPosY[j], world.prevPosZ[j]);
+        glm::vec3 end2(world.posX[j], world.posY[j], world.posZ[j]);
+        if (bounceTime <= 0.0f || AABB::SphereToSphere(end1, radius1, end2, world.radius[j])) {
+            // 一開始就接觸，或終點仍重疊：和離散檢測一樣在終點處理
+            ResolveSphereCollision(world.Ball(i), world.Ball(j), DrawCollisionRandoms(i, j));
+        } else {
+            // 終點已穿過對方：兩顆球退回接觸的位置，再做碰撞反應
+            glm::vec3 hit1 = start1 + (end1 - start1) * bounceTime;
+            glm::vec3 hit2 = start2 + (end2 - start2) * bounceTime;
+            glm::vec3 delta = hit2 - hit1;
+            float distance = glm::length(delta);
+            if (distance > 0.0001f) {
+                world.Ball(i).SetPosition(hit1);
+                world.Ball(j).SetPosition(hit2);
+                ApplyCollisionResponse(world.Ball(i), world.Ball(j), delta / distance, DrawCollisionRandoms(i, j));
+            }
+        }
+    }
+
+    // 掃掠只在最早的接觸反彈，離散檢測又跳過了快球的配對：停下的位置還和
+    // 別的球重疊時，和離散檢測一樣吃掉或推開。格子裡是解算前的終點，
+    // 多查 maxRadius 留給解算推開的距離
+    collisionGrid.ForEachInRadius(world.Ball(i).GetPosition(), radius1 + 2.0f * maxRadius, [&](uint32_t j) {
+        if (j == i || world.IsMarkedRemoved(i) || world.IsMarkedRemoved(j)) {
+            return;
+        }
+        glm::vec3 position1(world.posX[i], world.posY[i], world.posZ[i]);
+        glm::vec3 position2(world.posX[j], world.posY[j], world.posZ[j]);
+        if (!AABB::SphereToSphere(position1, radius1, position2, world.radius[j])) {
+            return;
+        }
+        bool predator2 = (world.flags[j] & BallWorld::kPredator) != 0;
+        if (predator1 != predator2) {
+            size_t predator = predator1 ? i : j;
+            size_t prey = predator1 ? j : i;
+            world.score[predator] += world.point[prey];
+            world.MarkRemoved(prey);
+            anyEaten = true;
+            return;
+        }
+        if (world.IsAsleep(j)) world.WakeUp(j);
+        ResolveSphereCollision(world.Ball(i), world.Ball(j), DrawCollisionRandoms(i, j));
+    });
+    return anyEaten;
+}
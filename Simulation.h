@@ -0,0 +1,126 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+#include "AABB.h"
+#include "BallWorld.h"
+#include "DrawBall.h"
+#include "SpatialGrid.h"
+#include "JobSystem.h"
+#include "FrameArena.h"
+#include "CounterRng.h"
+#include "Narrowphase.h"
+
+struct CollisionRandoms;
+
+// Owns the balls and steps the world: AI update, integration, collisions and eating.
+// No GL calls happen in here, so the same code drives the windowed app and the
+// headless runner.
+class Simulation {
+public:
+    explicit Simulation(const AABB& room);
+    ~Simulation();
+
+    // 預先配置可容納 ballCount 顆獵物加兩隻掠食者的球池
+    void Reserve(int ballCount);
+    // 只重建一般球（獵物），掠食者保留
+    void InitializeBalls(int count);
+    // 灰色 (FSM) 與紫色 (Fuzzy) 掠食者
+    void SpawnPredators();
+    void ResetBalls();
+    // 亂數種子：生成、重置與碰撞擾動都由 (種子, tick, 球的 handle) 算出，
+    // 同一個種子的結果與執行緒數和呼叫順序無關
+    void SetSeed(uint64_t seed) { rng.SetSeed(seed); }
+    uint64_t GetSeed() const { return rng.GetSeed(); }
+    uint32_t GetTick() const { return tick; }
+    // 載入快照時還原 tick（亂數的計數器之一，也是掠食者選目標計時器的時鐘）
+    void SetTick(uint32_t newTick) {
+        tick = newTick;
+        world.SetTick(newTick);
+    }
+    // 從頭開始一次可重現的執行：清空球池和 handle、tick 歸零、設定種子後
+    // 生成 ballCount 顆獵物與兩隻掠食者。目前的重力等設定會沿用
+    void Restart(uint64_t seed, int ballCount);
+    // 整個球池狀態的雜湊，錄製與重播用來逐 tick 比對
+    uint64_t StateHash() const { return world.StateHash(); }
+    // One fixed step; the previous positions are kept for render interpolation.
+    // Transient lists live in the frame arena, so after the first few steps a
+    // step makes no heap allocations.
+    void Step(float deltaTime);
+
+    // 連續碰撞：一步內移動超過自身半徑的球改用掃掠測試，大步長也不會穿過球
+    void SetContinuousCollision(bool enabled) { continuousCollision = enabled; }
+    bool GetContinuousCollision() const { return continuousCollision; }
+    // 睡眠：靜止在地板上的獵物不再積分，被碰到或掠食者靠近時醒來
+    void SetSleeping(bool enabled) { world.SetSleepEnabled(enabled); }
+    bool GetSleeping() const { return world.GetSleepEnabled(); }
+    // 威脅場的格點間距：掠食者每個 tick 把威脅畫進地板的 XZ 網格，獵物從網格
+    // 取樣閃避，不必逐一掃描掠食者。間距越小越接近逐一計算，建場越慢
+    void SetThreatCellSize(float size) { world.SetThreatCellSize(size); }
+    float GetThreatCellSize() const { return world.GetThreatCellSize(); }
+    // AI 排程：每個 tick 最多幾個掠食者重新選目標（0 = 不限），其餘的延後，
+    // 掠食者很多時 AI 的成本不會在計時器同時到期時暴增。焦點（攝影機的 XZ）
+    // 附近和靠近目標的掠食者優先
+    void SetAiBudget(int selectionsPerTick) { world.GetAiScheduler().SetBudget(selectionsPerTick); }
+    int GetAiBudget() const { return world.GetAiScheduler().GetBudget(); }
+    void SetAiFocus(const glm::vec2& focusXZ) { world.GetAiScheduler().SetFocus(focusXZ); }
+    glm::vec2 GetAiFocus() const { return world.GetAiScheduler().GetFocus(); }
+    const AiScheduler& GetAiScheduler() const { return world.GetAiScheduler(); }
+
+    void SetGravity(float strength);
+    float GetGravity() const { return gravityStrength; }
+    void SetPredatorSpeed(float speed);
+    float GetPredatorSpeed() const { return predatorSpeed; }
+    // Threads used by the agent update (including the caller); 1 = serial
+    void SetThreadCount(int threads);
+    int GetThreadCount() const { return jobs->GetThreadCount(); }
+
+    const AABB& GetRoom() const { return roomAABB; }
+    void SetRoom(const AABB& room) { roomAABB = room; }
+    BallWorld& GetWorld() { return world; }
+    const BallWorld& GetWorld() const { return world; }
+
+private:
+    // 球與球的接觸（a < b，附 narrowphase 算好的法線與穿透深度），由 ResolveContacts 著色後分批解算
+    using Contact = Narrowphase::Contact;
+    // 顏色數上限（每顆球用一個 64 位元遮罩記錄）；同一批少於這個數量就不分給工作執行緒
+    static constexpr int kMaxContactColors = 64;
+    static constexpr size_t kContactGrain = 1024;
+    // 接觸清單的上限（每顆球平均）；球堆得很密時超出的接觸當場逐一解算，
+    // 清單和 frame arena 因此有固定上限，可以在 Reserve 一次配置好
+    static constexpr size_t kMaxContactsPerBall = 8;
+    // 候選配對先收集這麼多筆，再一次交給 narrowphase 批次測試
+    static constexpr size_t kPairBatch = 256;
+    // CounterRng 的 stream：每個用到亂數的地方各用一個
+    enum RandomStream : uint32_t {
+        kStreamSpawn,
+        kStreamReset,
+        kStreamCollision,
+        kStreamCollisionJitter,
+    };
+
+    void ResolveCollisions();
+    // normalsValid：接觸產生時沒有球被當場解算移動過，narrowphase 的法線可以沿用
+    void ResolveContacts(bool normalsValid);
+    // 球 i 從 prevPos 到 pos 的掃掠：吃掉路徑上的獵物，並在第一個碰到的球處反彈，
+    // 停下後仍重疊的球再和離散檢測一樣處理。回傳是否有球被吃掉
+    bool SweepFastBall(uint32_t i, const float* stepLength, float maxRadius);
+    bool IsFast(const float* stepLength, uint32_t i) const;
+    // 球 i、j 這個 tick 碰撞用的亂數
+    CollisionRandoms DrawCollisionRandoms(uint32_t i, uint32_t j) const;
+
+    AABB roomAABB;
+    float gravityStrength;
+    float predatorSpeed;
+    bool continuousCollision;
+    CounterRng rng;
+    uint32_t tick; // 已經跑過的 step 數
+    BallWorld world;
+    std::unique_ptr<JobSystem> jobs;
+
+    // Broadphase 用的網格（每幀重用，避免重新配置）
+    SpatialGrid collisionGrid;
+    // 每個 step 開頭重設；step 內的暫存清單從這裡配置
+    FrameArena frameArena;
+    std::vector<Contact> contacts; // 每個 step 重用
+};
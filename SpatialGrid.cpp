@@ -0,0 +1,91 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Bounds the cell table: with few balls (or a tiny radius) coarser cells
+    // are cheaper than clearing a huge table every frame.
+    const size_t kCellsPerBall = 4;
+    const size_t kMinCells = 64;
+}
+
+SpatialGrid::SpatialGrid()
+    : origin(0.0f), cellSize(1.0f), invCellSize(1.0f),
+      dimX(1), dimY(1), dimZ(1),
+      cellStart(2, 0) {} // one empty cell, so queries before Build see nothing
+
+int SpatialGrid::CellCoord(float v, float minV, int dim) const {
+    int c = static_cast<int>(std::floor((v - minV) * invCellSize));
+    // Balls outside the room are clamped into the border cells
+    return std::min(std::max(c, 0), dim - 1);
+}
+
+void SpatialGrid::Build(const AABB& bounds, float size,
+                        const float* x, const float* y, const float* z, size_t count) {
+    // Fit the grid to the occupied part of the room; balls resting on the
+    // floor then collapse the Y axis to a single layer of cells.
+    glm::vec3 lo = bounds.GetMax();
+    glm::vec3 hi = bounds.GetMin();
+    for (size_t i = 0; i < count; i++) {
+        lo = glm::min(lo, glm::vec3(x[i], y[i], z[i]));
+        hi = glm::max(hi, glm::vec3(x[i], y[i], z[i]));
+    }
+    lo = glm::max(lo, bounds.GetMin());
+    hi = glm::max(glm::min(hi, bounds.GetMax()), lo);
+
+    glm::vec3 extent = hi - lo;
+    cellSize = std::max(size, 1e-4f);
+    origin = lo;
+    size_t maxCells = std::max(count * kCellsPerBall, kMinCells);
+    for (;;) {
+        invCellSize = 1.0f / cellSize;
+        dimX = std::max(1, static_cast<int>(std::ceil(extent.x * invCellSize)));
+        dimY = std::max(1, static_cast<int>(std::ceil(extent.y * invCellSize)));
+        dimZ = std::max(1, static_cast<int>(std::ceil(extent.z * invCellSize)));
+        if (GetCellCount() <= maxCells) break;
+        cellSize *= 1.25f;
+    }
+
+    size_t cells = GetCellCount();
+    cellStart.assign(cells + 1, 0);
+    cellEntries.resize(count);
+    ballCoords.resize(count * 3);
+
+    // Pass 1: count balls per cell
+    for (size_t i = 0; i < count; i++) {
+        int cx = CellCoord(x[i], origin.x, dimX);
+        int cy = CellCoord(y[i], origin.y, dimY);
+        int cz = CellCoord(z[i], origin.z, dimZ);
+        ballCoords[i * 3 + 0] = cx;
+        ballCoords[i * 3 + 1] = cy;
+        ballCoords[i * 3 + 2] = cz;
+        cellStart[CellIndex(cx, cy, cz) + 1]++;
+    }
+
+    // Pass 2: prefix sum
+    for (size_t c = 0; c < cells; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+
+    // Pass 3: scatter, walking balls in order keeps each cell sorted
+    scratch.assign(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        int cell = CellIndex(ballCoords[i * 3], ballCoords[i * 3 + 1], ballCoords[i * 3 + 2]);
+        cellEntries[scratch[cell]++] = static_cast<uint32_t>(i);
+    }
+}
+
+void SpatialGrid::Reserve(size_t maxCount) {
+    size_t maxCells = std::max(maxCount * kCellsPerBall, kMinCells);
+    cellStart.reserve(maxCells + 1);
+    cellEntries.reserve(maxCount);
+    ballCoords.reserve(maxCount * 3);
+    scratch.reserve(std::max(maxCells, maxCount));
+}
+
+void SpatialGrid::FindPairs(std::vector<Pair>& pairs) const {
+    pairs.clear();
+    ForEachPair([&pairs](uint32_t a, uint32_t b) {
+        pairs.push_back({ a, b });
+    });
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "AABB.h"
+
+// Uniform grid broadphase over the room AABB.
+// Balls are bucketed by their centre with a counting sort, so Build is O(n)
+// and FindPairs only visits the 27 cells around each ball.
+class SpatialGrid {
+public:
+    struct Pair {
+        uint32_t a; // always a < b
+        uint32_t b;
+    };
+
+    SpatialGrid();
+
+    // cellSize must be at least the largest ball diameter, otherwise
+    // overlapping balls can end up more than one cell apart.
+    void Build(const AABB& bounds, float cellSize,
+               const float* x, const float* y, const float* z, size_t count);
+
+    // Sizes the tables for up to maxCount balls, so Build never reallocates
+    void Reserve(size_t maxCount);
+
+    // Candidate pairs ordered by (a, b), i.e. the same order as the old i/j loop.
+    void FindPairs(std::vector<Pair>& pairs) const;
+
+    // Calls visit(a, b) for every candidate pair in FindPairs order without
+    // storing them, so the pair count never has to fit in a buffer.
+    // Uses the grid's scratch list: one caller at a time.
+    template <typename Visit>
+    void ForEachPair(const Visit& visit) const {
+        ForEachPair(visit, [](uint32_t) { return false; });
+    }
+
+    // Same, minus the pairs where asleep(index) holds for both balls. Sleeping
+    // balls are never walked from, so a mostly idle scene only pays for the
+    // neighbourhoods of its awake balls. Pairs still arrive as (a < b), sorted
+    // by their awake ball.
+    template <typename Visit, typename Asleep>
+    void ForEachPair(const Visit& visit, const Asleep& asleep) const {
+        size_t count = ballCoords.size() / 3;
+        for (size_t i = 0; i < count; i++) {
+            if (asleep(static_cast<uint32_t>(i))) continue;
+            int cx = ballCoords[i * 3];
+            int cy = ballCoords[i * 3 + 1];
+            int cz = ballCoords[i * 3 + 2];
+
+            scratch.clear();
+            for (int z = std::max(cz - 1, 0); z <= std::min(cz + 1, dimZ - 1); z++) {
+                for (int y = std::max(cy - 1, 0); y <= std::min(cy + 1, dimY - 1); y++) {
+                    for (int x = std::max(cx - 1, 0); x <= std::min(cx + 1, dimX - 1); x++) {
+                        int cell = CellIndex(x, y, z);
+                        for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+                            uint32_t j = cellEntries[k];
+                            if (j > i || (j < i && asleep(j))) {
+                                scratch.push_back(j);
+                            }
+                        }
+                    }
+                }
+            }
+
+            std::sort(scratch.begin(), scratch.end());
+            for (uint32_t j : scratch) {
+                uint32_t a = static_cast<uint32_t>(i);
+                visit(std::min(a, j), std::max(a, j));
+            }
+        }
+    }
+
+    // Calls visit(index) for every ball whose cell touches the box around the
+    // sphere (center, radius): a superset of the balls inside it, so callers
+    // still test the distance. Cells are walked in grid order, not index order.
+    // Reads nothing mutable, so several threads may query at once.
+    template <typename Visit>
+    void ForEachInRadius(const glm::vec3& center, float radius, const Visit& visit) const {
+        int x0 = CellCoord(center.x - radius, origin.x, dimX), x1 = CellCoord(center.x + radius, origin.x, dimX);
+        int y0 = CellCoord(center.y - radius, origin.y, dimY), y1 = CellCoord(center.y + radius, origin.y, dimY);
+        int z0 = CellCoord(center.z - radius, origin.z, dimZ), z1 = CellCoord(center.z + radius, origin.z, dimZ);
+        for (int z = z0; z <= z1; z++) {
+            for (int y = y0; y <= y1; y++) {
+                int rowStart = CellIndex(x0, y, z);
+                // A row of cells is contiguous in cellEntries
+                uint32_t begin = cellStart[rowStart];
+                uint32_t end = cellStart[rowStart + (x1 - x0) + 1];
+                for (uint32_t k = begin; k < end; k++) {
+                    visit(cellEntries[k]);
+                }
+            }
+        }
+    }
+
+    size_t GetCellCount() const { return static_cast<size_t>(dimX) * dimY * dimZ; }
+    float GetCellSize() const { return cellSize; }
+
+private:
+    int CellCoord(float v, float minV, int dim) const;
+    int CellIndex(int cx, int cy, int cz) const { return (cz * dimY + cy) * dimX + cx; }
+
+    glm::vec3 origin;
+    float cellSize;
+    float invCellSize;
+    int dimX, dimY, dimZ;
+
+    std::vector<uint32_t> cellStart;   // prefix sums, size cells + 1
+    std::vector<uint32_t> cellEntries; // ball indices grouped by cell, ascending within a cell
+    std::vector<int> ballCoords;       // cx, cy, cz per ball
+    mutable std::vector<uint32_t> scratch;
+};
@@ -0,0 +1,69 @@
+#include "ThreatField.h"
+#include <algorithm>
+#include <cmath>
+
+ThreatField::ThreatField()
+    : origin(0.0f), cellSize(1.0f), invCellSize(1.0f), radius(0.0f), countX(0), countZ(0) {}
+
+void ThreatField::Configure(const AABB& roomAABB, float newCellSize, float newRadius) {
+    glm::vec3 roomMin = roomAABB.GetMin();
+    glm::vec3 roomMax = roomAABB.GetMax();
+    origin = glm::vec2(roomMin.x, roomMin.z);
+    cellSize = newCellSize;
+    invCellSize = 1.0f / newCellSize;
+    radius = newRadius;
+    // A node on each wall, so every point in the room has four around it
+    countX = std::max(static_cast<int>(std::ceil((roomMax.x - roomMin.x) * invCellSize)), 1) + 1;
+    countZ = std::max(static_cast<int>(std::ceil((roomMax.z - roomMin.z) * invCellSize)), 1) + 1;
+    Clear();
+}
+
+void ThreatField::Clear() {
+    nodes.assign(static_cast<size_t>(countX) * countZ, Node{ 0.0f, 0.0f, 0.0f });
+}
+
+void ThreatField::Splat(float x, float z) {
+    // Nodes in the square around the predator; the distance test trims the corners
+    int x0 = std::max(static_cast<int>(std::ceil((x - radius - origin.x) * invCellSize)), 0);
+    int x1 = std::min(static_cast<int>(std::floor((x + radius - origin.x) * invCellSize)), countX - 1);
+    int z0 = std::max(static_cast<int>(std::ceil((z - radius - origin.y) * invCellSize)), 0);
+    int z1 = std::min(static_cast<int>(std::floor((z + radius - origin.y) * invCellSize)), countZ - 1);
+    for (int nz = z0; nz <= z1; nz++) {
+        float dz = origin.y + nz * cellSize - z;
+        for (int nx = x0; nx <= x1; nx++) {
+            float dx = origin.x + nx * cellSize - x;
+            float distance = std::sqrt(dx * dx + dz * dz);
+            if (distance >= radius) continue;
+            Node& node = nodes[static_cast<size_t>(nz) * countX + nx];
+            float falloff = (radius - distance) / radius;
+            node.threat += falloff;
+            // No direction right on top of the predator, as in the direct scan
+            if (distance > 0.001f) {
+                node.gradientX -= falloff * dx / distance;
+                node.gradientZ -= falloff * dz / distance;
+            }
+        }
+    }
+}
+
+ThreatField::Sample ThreatField::SampleAt(float x, float z) const {
+    float fx = glm::clamp((x - origin.x) * invCellSize, 0.0f, static_cast<float>(countX - 1));
+    float fz = glm::clamp((z - origin.y) * invCellSize, 0.0f, static_cast<float>(countZ - 1));
+    int x0 = std::min(static_cast<int>(fx), countX - 2);
+    int z0 = std::min(static_cast<int>(fz), countZ - 2);
+    float tx = fx - x0;
+    float tz = fz - z0;
+
+    const Node* row0 = &nodes[static_cast<size_t>(z0) * countX + x0];
+    const Node* row1 = row0 + countX;
+    float w00 = (1.0f - tx) * (1.0f - tz);
+    float w10 = tx * (1.0f - tz);
+    float w01 = (1.0f - tx) * tz;
+    float w11 = tx * tz;
+
+    Sample sample;
+    sample.threat = row0[0].threat * w00 + row0[1].threat * w10 + row1[0].threat * w01 + row1[1].threat * w11;
+    sample.gradient.x = row0[0].gradientX * w00 + row0[1].gradientX * w10 + row1[0].gradientX * w01 + row1[1].gradientX * w11;
+    sample.gradient.y = row0[0].gradientZ * w00 + row0[1].gradientZ * w10 + row1[0].gradientZ * w01 + row1[1].gradientZ * w11;
+    return sample;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstddef>
+#include "AABB.h"
+
+// Influence map of predator threat over the room's XZ plane.
+//
+// Nodes sit every cellSize across the floor. Each predator splats into the
+// nodes within radius of it, so a tick costs O(predators * (radius / cellSize)^2)
+// to build, and a prey reads its value and gradient from the four nodes
+// around it in O(1) instead of scanning the predators.
+//
+// A predator at distance d < radius contributes f = (radius - d) / radius, the
+// prey avoidance falloff. The gradient is that of the potential
+// Phi = radius / 2 * sum(f^2), i.e. -sum(f * away) with away the unit vector
+// from the predator, so -3 * gradient is the avoidance force the direct scan
+// summed. Both are stored per node exactly and interpolated bilinearly; a
+// node keeps its three values together, so a sample reads two short runs.
+// Heights are ignored: predators and prey chase each other on the floor.
+class ThreatField {
+public:
+    struct Sample {
+        float threat;       // sum of f; > 0 within about radius of a predator
+        glm::vec2 gradient; // d Phi / d(x, z)
+    };
+
+    ThreatField();
+
+    // Lays the nodes over roomAABB's XZ extent and clears them. Only
+    // reallocates when the node count changes.
+    void Configure(const AABB& roomAABB, float cellSize, float radius);
+    void Clear();
+    // Adds one predator at (x, z)
+    void Splat(float x, float z);
+    // Bilinear between the four nodes around (x, z), clamped to the room
+    Sample SampleAt(float x, float z) const;
+
+    int GetCountX() const { return countX; }
+    int GetCountZ() const { return countZ; }
+    float GetCellSize() const { return cellSize; }
+    float GetRadius() const { return radius; }
+    // World XZ position of node (0, 0)
+    glm::vec2 GetOrigin() const { return origin; }
+    // countX * countZ nodes row by row along X, each (threat, gradient x,
+    // gradient z) as three floats, for display
+    const float* GetNodes() const { return reinterpret_cast<const float*>(nodes.data()); }
+
+private:
+    struct Node {
+        float threat;
+        float gradientX;
+        float gradientZ;
+    };
+    static_assert(sizeof(Node) == 3 * sizeof(float), "GetNodes hands the nodes out as packed floats");
+
+    glm::vec2 origin;
+    float cellSize;
+    float invCellSize;
+    float radius;
+    int countX, countZ;
+    std::vector<Node> nodes;
+};
@@ -0,0 +1,63 @@
+#include "ThreatFieldRenderer.h"
+#include <GL/glew.h>
+
+ThreatFieldRenderer::ThreatFieldRenderer()
+    : shader(nullptr), uniforms(), slot(0), texture(0), width(0), height(0), worldMin(0.0f), worldSize(1.0f) {}
+
+void ThreatFieldRenderer::Init(Shader* roomShader, int textureSlot) {
+    shader = roomShader;
+    slot = textureSlot;
+    uniforms.threatTex = shader->GetUniform("threatTex");
+    uniforms.showThreat = shader->GetUniform("showThreat");
+    uniforms.threatMin = shader->GetUniform("threatMin");
+    uniforms.threatSize = shader->GetUniform("threatSize");
+
+    glGenTextures(1, &texture);
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+void ThreatFieldRenderer::Upload(const ThreatField& field) {
+    if (field.GetCountX() == 0) {
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if (field.GetCountX() != width || field.GetCountZ() != height) {
+        width = field.GetCountX();
+        height = field.GetCountZ();
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, width, height, 0, GL_RGB, GL_FLOAT, field.GetNodes());
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGB, GL_FLOAT, field.GetNodes());
+    }
+    // Texel centres sit on the nodes
+    float cellSize = field.GetCellSize();
+    worldMin = field.GetOrigin() - glm::vec2(0.5f * cellSize);
+    worldSize = glm::vec2(width * cellSize, height * cellSize);
+}
+
+void ThreatFieldRenderer::Apply(bool show) {
+    bool visible = show && width > 0;
+    shader->SetBool(uniforms.showThreat, visible);
+    if (!visible) {
+        return;
+    }
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    shader->SetInt(uniforms.threatTex, slot);
+    shader->SetVec2(uniforms.threatMin, worldMin);
+    shader->SetVec2(uniforms.threatSize, worldSize);
+}
+
+void ThreatFieldRenderer::Release() {
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+    width = 0;
+    height = 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Shader.h"
+#include "ThreatField.h"
+
+// Tints the floor by a ThreatField. Upload copies the nodes into a float
+// texture as they are (threat in red, the gradient in green / blue; one texel
+// per node, filtered linearly like the prey sample it); Apply sets the floor
+// uniforms before the room draw.
+class ThreatFieldRenderer {
+public:
+    ThreatFieldRenderer();
+
+    // Creates the texture on textureSlot and resolves the uniform handles
+    void Init(Shader* roomShader, int textureSlot);
+    void Upload(const ThreatField& field);
+    // Binds the texture and switches the tint on or off; the shader must be in use
+    void Apply(bool show);
+    // Needs the GL context, call before glfwTerminate
+    void Release();
+
+private:
+    struct Uniforms {
+        UniformHandle threatTex, showThreat, threatMin, threatSize;
+    };
+
+    Shader* shader;
+    Uniforms uniforms;
+    int slot;
+    unsigned int texture;
+    int width, height; // texture size, 0 until the first Upload
+    glm::vec2 worldMin;  // XZ of the corner of texel (0, 0)
+    glm::vec2 worldSize; // XZ extent of the whole texture
+};
@@ -0,0 +1,113 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel() : currentTick(0), pendingCount(0), head(kLevels * kSlots, kNone) {}
+
+void TimerWheel::Resize(size_t idCount) {
+    if (idCount > timers.size()) {
+        timers.resize(idCount, Timer{ kNoBucket, 0, kNone, kNone });
+    }
+}
+
+void TimerWheel::Reserve(size_t idCount) {
+    timers.reserve(idCount);
+}
+
+void TimerWheel::Reset(uint32_t tick) {
+    std::fill(head.begin(), head.end(), kNone);
+    for (Timer& timer : timers) {
+        timer.bucket = kNoBucket;
+    }
+    currentTick = tick;
+    pendingCount = 0;
+}
+
+void TimerWheel::Schedule(uint32_t id, uint32_t dueTick) {
+    if (timers[id].bucket != kNoBucket) {
+        Unlink(id);
+    } else {
+        pendingCount++;
+    }
+    uint32_t firstTick = currentTick + 1;
+    if (static_cast<int32_t>(dueTick - firstTick) < 0) {
+        dueTick = firstTick;
+    }
+    timers[id].due = dueTick;
+    Link(id, dueTick);
+}
+
+void TimerWheel::Cancel(uint32_t id) {
+    if (id < timers.size() && timers[id].bucket != kNoBucket) {
+        Unlink(id);
+        pendingCount--;
+    }
+}
+
+void TimerWheel::Link(uint32_t id, uint32_t dueTick) {
+    uint32_t firstTick = currentTick + 1;
+    uint32_t delay = dueTick - firstTick;
+    if (delay > kMaxDelay) {
+        // Parked in the far bucket of the top level; its cascade links it again from the real due tick
+        delay = kMaxDelay;
+        dueTick = firstTick + kMaxDelay;
+    }
+    int level = 0;
+    while (level < kLevels - 1 && delay >= (1u << (kSlotBits * (level + 1)))) {
+        level++;
+    }
+    uint32_t bucket = level * kSlots + ((dueTick >> (kSlotBits * level)) & (kSlots - 1));
+
+    Timer& timer = timers[id];
+    timer.bucket = bucket;
+    timer.prev = kNone;
+    timer.next = head[bucket];
+    if (head[bucket] != kNone) {
+        timers[head[bucket]].prev = id;
+    }
+    head[bucket] = id;
+}
+
+void TimerWheel::Unlink(uint32_t id) {
+    Timer& timer = timers[id];
+    if (timer.prev != kNone) {
+        timers[timer.prev].next = timer.next;
+    } else {
+        head[timer.bucket] = timer.next;
+    }
+    if (timer.next != kNone) {
+        timers[timer.next].prev = timer.prev;
+    }
+    timer.bucket = kNoBucket;
+}
+
+uint32_t TimerWheel::TakeDue() {
+    uint32_t tick = currentTick + 1;
+    uint32_t slot = tick & (kSlots - 1);
+
+    // A new round of level 0: the level 1 bucket for this round moves down,
+    // and so on up while the level above also starts a new round. Linking is
+    // relative to tick, so every timer lands in a lower level.
+    if (slot == 0) {
+        for (int level = 1; level < kLevels; level++) {
+            uint32_t levelSlot = (tick >> (kSlotBits * level)) & (kSlots - 1);
+            uint32_t bucket = level * kSlots + levelSlot;
+            uint32_t id = head[bucket];
+            head[bucket] = kNone;
+            while (id != kNone) {
+                uint32_t following = timers[id].next;
+                Link(id, timers[id].due);
+                id = following;
+            }
+            if (levelSlot != 0) break;
+        }
+    }
+
+    currentTick = tick;
+    uint32_t first = head[slot];
+    head[slot] = kNone;
+    for (uint32_t id = first; id != kNone; id = timers[id].next) {
+        timers[id].bucket = kNoBucket;
+        pendingCount--;
+    }
+    return first;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// Hierarchical timer wheel over integer ticks, for events that are far apart
+// compared to the tick (the predators' target reselections).
+//
+// Timers are identified by small ids (BallWorld uses ball slots), each with at
+// most one pending timer. Level 0 has one bucket per tick for the next
+// kSlots ticks; each level above covers kSlots times the span of the one
+// below with buckets as wide as that whole level. Scheduling and cancelling
+// are O(1): the timer is linked into the bucket of its level. Advancing one
+// tick visits only the bucket of timers due on it, plus, once every kSlots
+// ticks, one bucket of the level above, whose timers move down a level
+// ("cascade"). A timer cascades at most kLevels - 1 times, so ticks where
+// nothing is due cost next to nothing however many timers are pending.
+class TimerWheel {
+public:
+    static constexpr int kSlotBits = 6;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+    static constexpr int kLevels = 4;
+    // Timers further ahead than this are parked at the far end and rescheduled on the way down
+    static constexpr uint32_t kMaxDelay = (1u << (kSlotBits * kLevels)) - 1;
+
+    TimerWheel();
+
+    // Makes room for ids below idCount; never shrinks, pending timers are kept
+    void Resize(size_t idCount);
+    void Reserve(size_t idCount);
+    // Cancels every timer and puts the wheel at tick: the next Advance fires tick + 1
+    void Reset(uint32_t tick);
+    uint32_t GetTick() const { return currentTick; }
+
+    // Fires on the first Advance to dueTick or later; a due tick that has
+    // already passed fires on the next Advance. Replaces id's pending timer.
+    // dueTick must be less than 2^31 ticks away.
+    void Schedule(uint32_t id, uint32_t dueTick);
+    void Cancel(uint32_t id);
+    bool IsScheduled(uint32_t id) const { return id < timers.size() && timers[id].bucket != kNoBucket; }
+    size_t GetPendingCount() const { return pendingCount; }
+
+    // Moves the wheel to tick one tick at a time and calls fired(id) for
+    // every timer that comes due, each tick's timers in no particular order.
+    // A fired timer is no longer pending; fired may schedule it again but must
+    // not schedule or cancel other timers.
+    template <typename F>
+    void Advance(uint32_t tick, F&& fired) {
+        while (currentTick != tick) {
+            uint32_t id = TakeDue();
+            while (id != kNone) {
+                uint32_t following = timers[id].next;
+                fired(id);
+                id = following;
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+    static constexpr uint32_t kNoBucket = 0xFFFFFFFFu;
+
+    // Linked into its bucket's list; one cache line holds a timer's links and
+    // due tick, since firing and cascading visit timers in no memory order
+    struct Timer {
+        uint32_t bucket;
+        uint32_t due;
+        uint32_t next;
+        uint32_t prev;
+    };
+
+    // Moves to the next tick: cascades if it starts a new round, then unlinks
+    // the bucket due on it and returns its first id (the rest follow through Timer::next)
+    uint32_t TakeDue();
+    // Into the bucket for dueTick, counted from the next tick to fire
+    void Link(uint32_t id, uint32_t dueTick);
+    void Unlink(uint32_t id);
+
+    uint32_t currentTick;
+    size_t pendingCount;
+    std::vector<uint32_t> head; // kLevels * kSlots buckets, level by level
+    std::vector<Timer> timers;  // by id
+};
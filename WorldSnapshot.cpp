@@ -0,0 +1,255 @@
+#include "WorldSnapshot.h"
+#include "MappedFile.h"
+#include "Simulation.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+const char kMagic[8] = { 'B', 'W', 'S', 'N', 'A', 'P', 0, 0 };
+const uint32_t kVersion = 4;
+const uint64_t kArrayAlignment = 64;
+
+// Header::settings bits
+const uint32_t kContinuousCollision = 1u << 0;
+const uint32_t kSleeping = 1u << 1;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t arrayCount;
+    uint64_t ballCount;
+    uint64_t seed;
+    uint32_t tick;
+    uint32_t settings; // kContinuousCollision | kSleeping
+    float roomMin[3];
+    float roomMax[3];
+    float gravity;
+    float predatorSpeed;
+    float threatCellSize;
+    int32_t aiBudget;
+    float aiFocus[2]; // x, z
+};
+static_assert(sizeof(Header) == 88, "snapshot header layout changed; bump kVersion");
+
+struct ArrayEntry {
+    uint64_t offset; // from the start of the file
+    uint64_t count;
+    uint32_t elementSize;
+    uint32_t reserved;
+};
+static_assert(sizeof(ArrayEntry) == 24, "snapshot array entry layout changed; bump kVersion");
+
+// The last ForEachStateArray arrays are the slot table; the rest hold one element per ball
+const size_t kSlotTableArrays = 3;
+
+template <typename Vector>
+uint32_t ElementSize(const Vector&) {
+    return static_cast<uint32_t>(sizeof(typename std::decay_t<Vector>::value_type));
+}
+
+uint64_t AlignUp(uint64_t value) {
+    return (value + kArrayAlignment - 1) & ~(kArrayAlignment - 1);
+}
+
+// Position of array in ForEachStateArray order
+template <typename Vector>
+size_t ArrayPosition(const BallWorld& world, const Vector& array) {
+    size_t position = 0, found = 0;
+    world.ForEachStateArray([&](const auto& values) {
+        if (static_cast<const void*>(&values) == static_cast<const void*>(&array)) {
+            found = position;
+        }
+        position++;
+    });
+    return found;
+}
+
+template <typename Element>
+const Element* ArrayData(const unsigned char* data, const ArrayEntry& entry) {
+    // 64-byte aligned in a page-aligned mapping, so readable in place
+    return reinterpret_cast<const Element*>(data + entry.offset);
+}
+
+// The handles and the slot table must agree, or IndexOf, removal and
+// spawning would index past the arrays: every ball's slot maps back to it
+// with the ball's generation, free slots are in range, unique and not live,
+// and targets are null or in range. A target with the current generation of
+// its slot must be a live ball; other generations are stale handles to eaten
+// prey, which the predators drop on their next update. fsmState must be a valid state.
+bool ConsistentSlotTable(const unsigned char* data, const std::vector<ArrayEntry>& entries, const BallWorld& world,
+                         uint64_t ballCount) {
+    const ArrayEntry& slotIndexEntry = entries[entries.size() - kSlotTableArrays];
+    const ArrayEntry& generationEntry = entries[entries.size() - kSlotTableArrays + 1];
+    const ArrayEntry& freeEntry = entries[entries.size() - kSlotTableArrays + 2];
+    uint64_t slotCount = slotIndexEntry.count;
+    if (generationEntry.count != slotCount) {
+        return false;
+    }
+    const uint32_t* slotIndex = ArrayData<uint32_t>(data, slotIndexEntry);
+    const uint32_t* slotGeneration = ArrayData<uint32_t>(data, generationEntry);
+    const uint32_t* freeSlots = ArrayData<uint32_t>(data, freeEntry);
+    const BallHandle* handle = ArrayData<BallHandle>(data, entries[ArrayPosition(world, world.handle)]);
+    const BallHandle* targetHandle = ArrayData<BallHandle>(data, entries[ArrayPosition(world, world.targetHandle)]);
+    using FSMValue = std::underlying_type_t<FSMState>;
+    const FSMValue* fsmState = ArrayData<FSMValue>(data, entries[ArrayPosition(world, world.fsmState)]);
+
+    enum : uint8_t { kUnused, kLive, kFree };
+    std::vector<uint8_t> used(slotCount, kUnused);
+    for (uint64_t i = 0; i < ballCount; i++) {
+        uint32_t slot = handle[i] & BallWorld::kMaxSlots;
+        if (slot >= slotCount || used[slot] || slotIndex[slot] != i ||
+            slotGeneration[slot] != (handle[i] >> BallWorld::kSlotBits)) {
+            return false;
+        }
+        used[slot] = kLive;
+        if (fsmState[i] != static_cast<FSMValue>(FSMState::SelectTarget) &&
+            fsmState[i] != static_cast<FSMValue>(FSMState::ChaseTarget)) {
+            return false;
+        }
+    }
+    for (uint64_t k = 0; k < freeEntry.count; k++) {
+        if (freeSlots[k] >= slotCount || used[freeSlots[k]]) {
+            return false;
+        }
+        used[freeSlots[k]] = kFree;
+    }
+    for (uint64_t i = 0; i < ballCount; i++) {
+        if (targetHandle[i] == BallWorld::kNullHandle) {
+            continue;
+        }
+        uint32_t slot = targetHandle[i] & BallWorld::kMaxSlots;
+        if (slot >= slotCount ||
+            (slotGeneration[slot] == (targetHandle[i] >> BallWorld::kSlotBits) && used[slot] != kLive)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+namespace WorldSnapshot {
+
+bool Save(const std::string& path, const Simulation& simulation) {
+    const BallWorld& world = simulation.GetWorld();
+
+    std::vector<ArrayEntry> entries;
+    world.ForEachStateArray([&entries](const auto& values) {
+        entries.push_back({ 0, values.size(), ElementSize(values), 0 });
+    });
+    uint64_t offset = sizeof(Header) + entries.size() * sizeof(ArrayEntry);
+    for (ArrayEntry& entry : entries) {
+        entry.offset = AlignUp(offset);
+        offset = entry.offset + entry.count * entry.elementSize;
+    }
+
+    Header header = {};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.arrayCount = static_cast<uint32_t>(entries.size());
+    header.ballCount = world.Size();
+    header.seed = simulation.GetSeed();
+    header.tick = simulation.GetTick();
+    header.settings = (simulation.GetContinuousCollision() ? kContinuousCollision : 0u) |
+                      (simulation.GetSleeping() ? kSleeping : 0u);
+    glm::vec3 roomMin = simulation.GetRoom().GetMin();
+    glm::vec3 roomMax = simulation.GetRoom().GetMax();
+    for (int axis = 0; axis < 3; axis++) {
+        header.roomMin[axis] = roomMin[axis];
+        header.roomMax[axis] = roomMax[axis];
+    }
+    header.gravity = simulation.GetGravity();
+    header.predatorSpeed = simulation.GetPredatorSpeed();
+    header.threatCellSize = simulation.GetThreatCellSize();
+    header.aiBudget = simulation.GetAiBudget();
+    header.aiFocus[0] = simulation.GetAiFocus().x;
+    header.aiFocus[1] = simulation.GetAiFocus().y;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ArrayEntry));
+
+    uint64_t written = sizeof(Header) + entries.size() * sizeof(ArrayEntry);
+    size_t a = 0;
+    world.ForEachStateArray([&](const auto& values) {
+        static const char padding[kArrayAlignment] = {};
+        file.write(padding, static_cast<std::streamsize>(entries[a].offset - written));
+        file.write(reinterpret_cast<const char*>(values.data()),
+                   static_cast<std::streamsize>(entries[a].count * entries[a].elementSize));
+        written = entries[a].offset + entries[a].count * entries[a].elementSize;
+        a++;
+    });
+    return static_cast<bool>(file);
+}
+
+bool Load(const std::string& path, Simulation& simulation) {
+    MappedFile mapped;
+    if (!mapped.Open(path) || mapped.GetSize() < sizeof(Header)) {
+        return false;
+    }
+    const unsigned char* data = mapped.GetData();
+    uint64_t fileSize = mapped.GetSize();
+
+    // Validate everything before touching the simulation
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    std::vector<uint32_t> expectedSizes;
+    simulation.GetWorld().ForEachStateArray([&expectedSizes](const auto& values) {
+        expectedSizes.push_back(ElementSize(values));
+    });
+    if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.arrayCount != expectedSizes.size() || header.ballCount > BallWorld::kMaxSlots ||
+        sizeof(Header) + header.arrayCount * sizeof(ArrayEntry) > fileSize) {
+        return false;
+    }
+    std::vector<ArrayEntry> entries(header.arrayCount);
+    memcpy(entries.data(), data + sizeof(Header), entries.size() * sizeof(ArrayEntry));
+    for (size_t a = 0; a < entries.size(); a++) {
+        const ArrayEntry& entry = entries[a];
+        bool perBall = a < entries.size() - kSlotTableArrays;
+        if (entry.elementSize != expectedSizes[a] || (perBall && entry.count != header.ballCount) ||
+            entry.count > BallWorld::kMaxSlots || entry.offset > fileSize || entry.offset % kArrayAlignment != 0 ||
+            entry.count * entry.elementSize > fileSize - entry.offset) {
+            return false;
+        }
+    }
+    if (!ConsistentSlotTable(data, entries, simulation.GetWorld(), header.ballCount)) {
+        return false;
+    }
+
+    BallWorld& world = simulation.GetWorld();
+    world.Reset();
+    simulation.SetRoom(AABB(glm::vec3(header.roomMin[0], header.roomMin[1], header.roomMin[2]),
+                            glm::vec3(header.roomMax[0], header.roomMax[1], header.roomMax[2])));
+    simulation.SetGravity(header.gravity);
+    simulation.SetPredatorSpeed(header.predatorSpeed);
+    simulation.SetContinuousCollision((header.settings & kContinuousCollision) != 0);
+    simulation.SetSleeping((header.settings & kSleeping) != 0);
+    simulation.SetThreatCellSize(header.threatCellSize);
+    simulation.SetAiBudget(header.aiBudget);
+    simulation.SetAiFocus(glm::vec2(header.aiFocus[0], header.aiFocus[1]));
+    simulation.Reserve(static_cast<int>(header.ballCount));
+
+    size_t a = 0;
+    world.ForEachStateArray([&](auto& values) {
+        // Arrays start 64-byte aligned in a page-aligned mapping, so the
+        // bytes can be read in place as elements; assign copies them once
+        // (resize + memcpy would zero-fill the array first)
+        using Element = typename std::decay_t<decltype(values)>::value_type;
+        const ArrayEntry& entry = entries[a++];
+        const Element* first = reinterpret_cast<const Element*>(data + entry.offset);
+        values.assign(first, first + entry.count);
+    });
+    simulation.SetSeed(header.seed);
+    simulation.SetTick(header.tick);
+    return true;
+}
+
+} // namespace WorldSnapshot
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+
+class Simulation;
+
+// Binary snapshot of a whole Simulation: every BallWorld state array plus the
+// slot table, the room, the settings and the RNG counters (seed, tick).
+//
+// Layout (version 4, little-endian):
+//   Header       fixed size, see WorldSnapshot.cpp
+//   ArrayEntry   one per BallWorld::ForEachStateArray array: byte offset,
+//                element count, element size
+//   array data   raw element bytes, each array starting on a 64-byte boundary
+//
+// Saving writes the header and then each array in one sequential pass.
+// Loading maps the file and copies each array with one memcpy; nothing is
+// parsed per field. Target references are handles, which stay valid because
+// the slot table is restored with the arrays.
+namespace WorldSnapshot {
+
+bool Save(const std::string& path, const Simulation& simulation);
+// Replaces the simulation's world and settings. On failure (missing file,
+// other version, truncated data, handles that disagree with the slot table)
+// the simulation is left untouched.
+bool Load(const std::string& path, Simulation& simulation);
+
+} // namespace WorldSnapshot
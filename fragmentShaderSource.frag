@@ -3,28 +3,59 @@
 in vec3 Normal;
 in vec3 FragPos;
 in vec2 TexCoord;
+in vec3 InstanceColor;
 
 uniform sampler2D miniTex;
 uniform sampler2D roomTex;
 uniform bool isRoom;
 uniform bool isbox;
+uniform bool isInstanced;
 
-uniform vec3 ambientColor;
-uniform vec3 lightPos;
-uniform vec3 lightColor;
-uniform vec3 lightPos2;
-uniform vec3 lightColor2;
-uniform vec3 cameraPos;
 uniform vec3 objColor;
-uniform bool light1Enabled; // 第一個光源開關
-uniform bool light2Enabled; // 第二個光源開關
+
+// 地板上的威脅場（見 ThreatFieldRenderer）：XZ 世界座標對應到貼圖
+uniform sampler2D threatTex;
+uniform bool showThreat;
+uniform vec2 threatMin;
+uniform vec2 threatSize;
+
+struct LightSet {
+    vec4 ambientColor;
+    vec4 lightPos;
+    vec4 lightColor;
+    vec4 lightPos2;
+    vec4 lightColor2;
+};
+
+// 每個視口一份，見 SceneUniformBuffer
+layout (std140) uniform ViewData {
+    mat4 viewMat;
+    mat4 projMat;
+    vec4 cameraPos;
+};
+
+// 每幀一份：房間與球各用一組光源
+layout (std140) uniform FrameData {
+    LightSet roomLights;
+    LightSet ballLights;
+    ivec4 lightEnabled; // x: 第一個光源開關, y: 第二個光源開關
+};
 
 
 out vec4 FragColor;
 
 void main() {
+    LightSet lights = isRoom ? roomLights : ballLights;
+    vec3 ambientColor = lights.ambientColor.xyz;
+    vec3 lightPos = lights.lightPos.xyz;
+    vec3 lightColor = lights.lightColor.xyz;
+    vec3 lightPos2 = lights.lightPos2.xyz;
+    vec3 lightColor2 = lights.lightColor2.xyz;
+    bool light1Enabled = lightEnabled.x != 0;
+    bool light2Enabled = lightEnabled.y != 0;
+
     vec3 norm = normalize(Normal);
-    vec3 cameraVec = normalize(cameraPos - FragPos);
+    vec3 cameraVec = normalize(cameraPos.xyz - FragPos);
 
     // 第一個光源
     vec3 diffuse1 = vec3(0.0);
@@ -78,12 +109,17 @@ void main() {
             vec3 mixedColor = mix(texColor.rgb, gray, wallMixFactor);
             finalColor = vec4(mixedColor * lighting, texColor.a);
         } else {
-            // 地板：保持原始貼圖效果
-            finalColor = vec4(texColor.rgb * lighting, texColor.a);
+            // 地板：保持原始貼圖效果，開啟威脅場時越靠近掠食者越紅
+            vec3 floorColor = texColor.rgb;
+            if (showThreat) {
+                float threat = texture(threatTex, (FragPos.xz - threatMin) / threatSize).r;
+                floorColor = mix(floorColor, vec3(1.0, 0.1, 0.1), clamp(threat, 0.0, 1.0) * 0.7);
+            }
+            finalColor = vec4(floorColor * lighting, texColor.a);
         }
     } 
     else { //ball
-        vec4 texColor = vec4(objColor, 1.0);
+        vec4 texColor = vec4(isInstanced ? InstanceColor : objColor, 1.0);
         finalColor = vec4(texColor.rgb * lighting, texColor.a);
     }
    
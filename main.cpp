@@ -16,8 +16,19 @@
 #include "model_data.h"
 #include "DrawBall.h"
 #include "AABB.h"
+#include "Simulation.h"
+#include "BallRenderer.h"
+#include "ThreatFieldRenderer.h"
+#include "SceneUniformBuffer.h"
+#include "FixedTimestep.h"
+#include "InputRecording.h"
+#include "WorldSnapshot.h"
+#include "RewindBuffer.h"
+#include "SimdLevel.h"
 #include <vector>
 #include <algorithm>
+#include <thread>
+#include <ctime>
 
 #pragma region Model Data
 
@@ -120,149 +131,58 @@ float gravityStrength = 9.8f;
 float predatorSpeed = 5.0f; // 掠食者速度控制
 bool resetBall = false;
 
-std::vector<DrawBall*> balls; 
+Simulation simulation(roomAABB);
+// 固定步長：模擬頻率與渲染幀率脫鉤
+int simulationHz = 120;
+int maxSubsteps = 8;
+bool interpolateRender = true;
+// 連續碰撞（掃掠測試），關掉可比較大步長時的穿透
+bool continuousCollision = true;
+// 靜止獵物的睡眠
+bool sleepingEnabled = true;
+// 威脅場的格點間距，以及是否把威脅場畫在地板上
+float threatCellSize = BallWorld::kThreatCellSize;
+bool showThreatField = false;
+// 每 tick 最多幾隻掠食者重選目標（0 = 不限），以及送進模擬的 AI 焦點（相機 XZ，公分量化）
+int aiBudget = 0;
+int32_t aiFocusPacked = 0;
+FixedTimestep fixedTimestep(static_cast<float>(simulationHz), maxSubsteps);
+int stepsThisFrame = 0;
+// Agent update 的執行緒數（含主執行緒）
+int workerThreads = 1;
+int maxWorkerThreads = 1;
 int maxBalls = 30;
 int currentBalls = 1; 
 
-void InitializeBalls(int count, GLuint VAO, int vertexCount) {
-    // 只清除 isPredator 為 false 的球
-    balls.erase(std::remove_if(balls.begin(), balls.end(), [](DrawBall* ball) {
-        if (!ball->IsPredator()) {
-            delete ball;
-            return true;
-        }
-        return false;
-    }), balls.end());
-
-    // 獲取房間的邊界
-    glm::vec3 roomMin = roomAABB.GetMin();
-    glm::vec3 roomMax = roomAABB.GetMax();
-
-    // 生成指定數量的非掠食者球
-    for (int i = 0; i < count; i++) {
-        float scale = 0.1f;
-        DrawBall* ball = new DrawBall(VAO, vertexCount, scale);
-        ball->SetScale(scale);
-        
-        // 隨機分配顏色和分數
-        int colorType = rand() % 3;
-        if (colorType == 0) {
-            // 紅球 - 15 points
-            ball->SetColor(glm::vec3(1.0f, 0.0f, 0.0f));
-            ball->SetPoint(15);
-        } else if (colorType == 1) {
-            // 橙球 - 10 points
-            ball->SetColor(glm::vec3(1.0f, 0.5f, 0.0f));
-            ball->SetPoint(10);
-        } else {
-            // 黃球 - 5 points
-            ball->SetColor(glm::vec3(1.0f, 1.0f, 0.0f));
-            ball->SetPoint(5);
-        }
-        
-        float x = roomMin.x + scale + (static_cast<float>(rand()) / RAND_MAX) * (roomMax.x - roomMin.x - 2.0f * scale);
-        float z = roomMin.z + scale + (static_cast<float>(rand()) / RAND_MAX) * (roomMax.z - roomMin.z - 2.0f * scale);
-        float y = roomMin.y + scale;
-        glm::vec3 position(x, y, z);
-
-        ball->SetPosition(position);
-        
-        // 根據分數設定初始速度
-        float speed = 0.0f;
-        if (ball->GetPoint() == 15) speed = 4.0f;      // 紅球
-        else if (ball->GetPoint() == 10) speed = 3.0f; // 橙球
-        else if (ball->GetPoint() == 5) speed = 2.0f;  // 黃球
-        
-        // 隨機方向的水平速度
-        float randomX = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * speed;
-        float randomZ = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * speed;
-        ball->SetVelocity(glm::vec3(randomX, 0.0f, randomZ));
-        
-        ball->SetGravity(-gravityStrength);
-        ball->SetIsPredator(false); // 標記為非掠食者
-        balls.push_back(ball);
-    }
-}
-
-void ResolveSphereCollision(DrawBall* ball1, DrawBall* ball2) {
-    float randomFactor = 0.2f;
-    glm::vec3 pos1 = ball1->GetPosition();
-    glm::vec3 pos2 = ball2->GetPosition();
-    float radius1 = ball1->GetScale();
-    float radius2 = ball2->GetScale();
-
-    glm::vec3 delta = pos2 - pos1;
-    float distance = glm::length(delta);
-
-    if (distance < 0.0001f) {
-        delta = glm::vec3(static_cast<float>(rand()) / RAND_MAX - 0.5f);
-        distance = glm::length(delta);
-    }
-
-    float overlap = (radius1 + radius2) - distance;
-
-    if (overlap <= 0) {
-        return;
-    }
-
-
-    glm::vec3 normal = delta / distance;
-
-    float totalMass = 1.0f;
-    float correction1 = overlap * 0.5f;
-    float correction2 = overlap * 0.5f;
-
-    ball1->SetPosition(pos1 - normal * correction1);
-    ball2->SetPosition(pos2 + normal * correction2);
-
-    pos1 = ball1->GetPosition();
-    pos2 = ball2->GetPosition();
-
-    glm::vec3 vel1 = ball1->GetVelocity();
-    glm::vec3 vel2 = ball2->GetVelocity();
-
-    float v1n = glm::dot(vel1, normal);
-    float v2n = glm::dot(vel2, normal);
+// 輸入錄製：會改變模擬結果的控制項都經過 SendInput，錄製時一併寫入檔案，
+// 之後用 3DRenderHeadless --replay 在無視窗下重播並逐 tick 比對狀態雜湊
+InputRecorder inputRecorder;
+char recordingPath[256] = "session.bwrec";
 
-    if (v1n > v2n) {
-        return;
-    }
-
-    float restitution = 0.6f;
-
-    float v1nAfter = (v1n * (0.0f) + v2n * 2.0f) / 2.0f;
-    float v2nAfter = (v2n * (0.0f) + v1n * 2.0f) / 2.0f;
-
-    v1nAfter = v1n + restitution * (v1nAfter - v1n);
-    v2nAfter = v2n + restitution * (v2nAfter - v2n);
-
-    glm::vec3 v1nVector = normal * v1nAfter;
-    glm::vec3 v2nVector = normal * v2nAfter;
-
-    glm::vec3 v1t = vel1 - (normal * v1n);
-    glm::vec3 v2t = vel2 - (normal * v2n);
-
-    ball1->SetVelocity(v1t + v1nVector);
-    ball2->SetVelocity(v2t + v2nVector);
+// 世界快照：整個球池與設定存成一個檔案，載入時直接映射檔案複製回來
+char snapshotPath[256] = "world.bwsnap";
 
-    // 添加隨機擾動（只有在速度大於閾值時）
+// 倒帶：每個 tick 存一份差分，暫停後可拖時間軸回到任一 tick 再繼續
+int rewindBudgetMB = 64;
+RewindBuffer rewindBuffer(static_cast<size_t>(rewindBudgetMB) << 20);
+bool simulationPaused = false;
+int rewindTick = 0;
 
-    if (glm::length(ball1->GetVelocity()) > 0.05f) {
-        ball1->SetVelocity(ball1->GetVelocity() + glm::vec3(
-            (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * randomFactor,
-            0.0f,
-            (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * randomFactor
-        ));
-    }
-    if (glm::length(ball2->GetVelocity()) > 0.05f) {
-        ball2->SetVelocity(ball2->GetVelocity() + glm::vec3(
-            (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * randomFactor,
-            0.0f,
-            (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * randomFactor
-        ));
-    }
+void SendInput(const InputEvent& input) {
+    ApplyInput(simulation, input);
+    inputRecorder.AddEvent(input);
+}
 
-    // 移除了碰撞後的減速效果
+// 模擬被整個換掉（快照、倒帶）後，控制項跟著模擬的設定
+void SyncControls() {
+    gravityStrength = simulation.GetGravity();
+    predatorSpeed = simulation.GetPredatorSpeed();
+    continuousCollision = simulation.GetContinuousCollision();
+    sleepingEnabled = simulation.GetSleeping();
+    threatCellSize = simulation.GetThreatCellSize();
+    aiBudget = simulation.GetAiBudget();
+    aiFocusPacked = PackAiFocus(simulation.GetAiFocus());
+    currentBalls = std::min(std::max(static_cast<int>(simulation.GetWorld().Size()) - 2, 1), maxBalls);
 }
 
 float ceilingMixFactor = 0.5f;
@@ -272,12 +192,16 @@ float groundFriction = 0.99f;
 bool light1Enabled = true; // 第一個光源開關
 bool light2Enabled = true; // 第二個光源開關
 
+// 房間繪製用的 uniform handle，shader 建好後查一次
+// （相機與光源改由 SceneUniformBuffer 的 UBO 提供）
+struct RoomUniforms {
+    UniformHandle roomTex, isRoom, isbox, isInstanced;
+    UniformHandle modelMat, objColor;
+};
 
 
-int main() {
-    DrawBall* greyBall = nullptr;
-    DrawBall* purpleBall = nullptr;
 
+int main() {
     #pragma region Open a Window
         if (!glfwInit()) {
             printf("Failed to initialize GLFW\n");
@@ -326,6 +250,30 @@ int main() {
     #pragma region Init Shader Program
     // load vertex and fragment shader
     Shader* myShader = new Shader("vertexShaderSource.vert", "fragmentShaderSource.frag");
+
+    RoomUniforms roomUniforms;
+    roomUniforms.roomTex = myShader->GetUniform("roomTex");
+    roomUniforms.isRoom = myShader->GetUniform("isRoom");
+    roomUniforms.isbox = myShader->GetUniform("isbox");
+    roomUniforms.isInstanced = myShader->GetUniform("isInstanced");
+    roomUniforms.modelMat = myShader->GetUniform("modelMat");
+    roomUniforms.objColor = myShader->GetUniform("objColor");
+
+    // 視口 0：主攝影機，視口 1：頂視圖
+    SceneUniformBuffer sceneUniforms;
+    sceneUniforms.Init(myShader, 2);
+    SceneUniformBuffer::LightSet& roomLights = sceneUniforms.Frame().roomLights;
+    roomLights.ambientColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+    roomLights.lightPos = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    roomLights.lightColor = glm::vec4(0.5f, 0.5f, 0.5f, 0.0f);
+    roomLights.lightPos2 = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    roomLights.lightColor2 = glm::vec4(0.2f, 0.7f, 0.9f, 0.0f);
+    SceneUniformBuffer::LightSet& ballLights = sceneUniforms.Frame().ballLights;
+    ballLights.ambientColor = glm::vec4(0.3f, 0.3f, 0.3f, 0.0f);
+    ballLights.lightPos = glm::vec4(2.0f, 4.0f, 2.0f, 1.0f);
+    ballLights.lightColor = glm::vec4(0.8f, 0.8f, 0.8f, 0.0f);
+    ballLights.lightPos2 = glm::vec4(-2.0f, 4.0f, -2.0f, 1.0f);
+    ballLights.lightColor2 = glm::vec4(0.6f, 0.6f, 0.6f, 0.0f);
     
     #pragma endregion
     
@@ -353,6 +301,13 @@ int main() {
     glVertexAttribPointer(9, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(5 * sizeof(float))); 
     glEnableVertexAttribArray(9);
 
+    // 球的 instance buffer（位置 + 縮放、顏色），所有球一次 instanced draw
+    BallRenderer ballRenderer;
+    ballRenderer.Init(myShader, VAO, vertexCount);
+    // 地板的威脅場貼圖用第 4 個貼圖單元（0、3 是房間與箱子的貼圖）
+    ThreatFieldRenderer threatRenderer;
+    threatRenderer.Init(myShader, 4);
+
     
     // room VAO & VBO
     unsigned int roomVAO, roomVBO;
@@ -409,35 +364,19 @@ int main() {
     // Time initialization
     lastFrame = glfwGetTime();
     
+    maxWorkerThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    workerThreads = maxWorkerThreads;
+    simulation.SetThreadCount(workerThreads);
+
+    // 球池一次配置到滑桿上限，之後調整球數不再配置記憶體
+    simulation.Reserve(maxBalls);
+
     // 初始化受 ImGui 控制的球
-    InitializeBalls(currentBalls, VAO, vertexCount);
+    simulation.InitializeBalls(currentBalls);
 
     // 創建兩顆掠食者球
-    // 灰色球
-    float greyBallScale = 0.1f;
-    greyBall = new DrawBall(VAO, vertexCount, greyBallScale);
-    greyBall->SetScale(greyBallScale);
-    greyBall->SetPosition(glm::vec3(-2.0f, roomAABB.GetMin().y + 0.1f, -2.0f));
-    greyBall->SetVelocity(glm::vec3(0.0f, 0.0f, 0.0f)); // 掠食者速度為0
-    greyBall->SetColor(glm::vec3(0.5f, 0.5f, 0.5f));
-    greyBall->SetGravity(-gravityStrength);
-    greyBall->SetIsPredator(true); // 設為掠食者
-    greyBall->SetScore(0); // 初始分數為0
-    greyBall->SetPredatorSpeed(predatorSpeed); // 設定掠食者速度
-    balls.push_back(greyBall);
-
-    // 紫色球
-    float purpleBallScale = 0.1f;
-    purpleBall = new DrawBall(VAO, vertexCount, purpleBallScale);
-    purpleBall->SetScale(purpleBallScale);
-    purpleBall->SetPosition(glm::vec3(2.0f, roomAABB.GetMin().y + 0.1f, 2.0f));
-    purpleBall->SetVelocity(glm::vec3(0.0f, 0.0f, 0.0f)); // 掠食者速度為0
-    purpleBall->SetColor(glm::vec3(0.5f, 0.0f, 0.5f));
-    purpleBall->SetGravity(-gravityStrength);
-    purpleBall->SetIsPredator(true); // 設為掠食者
-    purpleBall->SetScore(0); // 初始分數為0
-    purpleBall->SetPredatorSpeed(predatorSpeed); // 設定掠食者速度
-    balls.push_back(purpleBall);
+    simulation.SpawnPredators();
+    rewindBuffer.Capture(simulation);
 
     while (!glfwWindowShouldClose(window)) {
         // Calculate delta time
@@ -447,6 +386,22 @@ int main() {
 
         // Process input
         processInput(window);
+
+        // 以固定 dt 推進模擬，慢幀最多補 maxSubsteps 步
+        stepsThisFrame = simulationPaused ? 0 : fixedTimestep.Advance(deltaTime);
+        // 相機移動才送出新焦點，量化後沒變就不記錄
+        int32_t cameraFocus = PackAiFocus(glm::vec2(camera.Position.x, camera.Position.z));
+        if (stepsThisFrame > 0 && cameraFocus != aiFocusPacked) {
+            aiFocusPacked = cameraFocus;
+            SendInput({ InputType::SetAiFocus, 0.0f, aiFocusPacked });
+        }
+        for (int step = 0; step < stepsThisFrame; step++) {
+            simulation.Step(fixedTimestep.GetStep());
+            if (inputRecorder.IsOpen()) {
+                inputRecorder.EndTick(fixedTimestep.GetStep(), simulation.StateHash());
+            }
+            rewindBuffer.Capture(simulation);
+        }
             
         // Clear screen
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -493,76 +448,175 @@ int main() {
         ImGui::Text("Physics Controls");
         
         if (ImGui::SliderFloat("Gravity", &gravityStrength, 0.0f, 20.0f)) {
-            for (auto ball : balls) {
-                ball->SetGravity(-gravityStrength);
-            }
+            SendInput({ InputType::SetGravity, gravityStrength, 0 });
         }
         
         // 球數量控制
         int oldBallCount = currentBalls;
         if (ImGui::SliderInt("Ball Count", &currentBalls, 1, maxBalls)) {
-            InitializeBalls(currentBalls, VAO, vertexCount);
+            SendInput({ InputType::SetBallCount, 0.0f, currentBalls });
         }
 
         // 掠食者速度控制
         if (ImGui::SliderFloat("Predator Speed", &predatorSpeed, 1.0f, 10.0f)) {
-            // 同步到所有掠食者
-            for (auto ball : balls) {
-                if (ball->IsPredator()) {
-                    ball->SetPredatorSpeed(predatorSpeed);
-                }
-            }
+            SendInput({ InputType::SetPredatorSpeed, predatorSpeed, 0 });
         }
 
         if (ImGui::Button("Reset Balls")) {
-            glm::vec3 roomMin = roomAABB.GetMin();
-            glm::vec3 roomMax = roomAABB.GetMax();
-            for (auto ball : balls) {
-                float scale = ball->GetScale();
-                float x = roomMin.x + scale + (static_cast<float>(rand()) / RAND_MAX) * (roomMax.x - roomMin.x - 2.0f * scale);
-                float z = roomMin.z + scale + (static_cast<float>(rand()) / RAND_MAX) * (roomMax.z - roomMin.z - 2.0f * scale);
-                float y = roomMin.y + scale;
-                ball->SetPosition(glm::vec3(x, y, z));
-                // 如果是掠食者，重設分數和AI狀態
-                if (ball->IsPredator()) {
-                    ball->SetScore(0);
-                    ball->SetVelocity(glm::vec3(0.0f));
-                    ball->ResetAIState(); // 重置AI狀態
+            SendInput({ InputType::ResetBalls, 0.0f, 0 });
+        }
+        const BallWorld& pool = simulation.GetWorld();
+        ImGui::Text("Ball Pool: %zu / %zu (%.0f%%)", pool.Size(), pool.Capacity(),
+                    pool.Capacity() > 0 ? 100.0 * pool.Size() / pool.Capacity() : 0.0);
+
+        // 固定步長控制
+        if (ImGui::SliderInt("Simulation Hz", &simulationHz, 30, 240)) {
+            fixedTimestep.SetRate(static_cast<float>(simulationHz));
+        }
+        if (ImGui::SliderInt("Max Substeps", &maxSubsteps, 1, 16)) {
+            fixedTimestep.SetMaxSubsteps(maxSubsteps);
+        }
+        ImGui::Checkbox("Interpolate Rendering", &interpolateRender);
+        if (ImGui::Checkbox("Continuous Collision", &continuousCollision)) {
+            SendInput({ InputType::SetContinuousCollision, 0.0f, continuousCollision ? 1 : 0 });
+        }
+        if (ImGui::Checkbox("Sleeping", &sleepingEnabled)) {
+            SendInput({ InputType::SetSleeping, 0.0f, sleepingEnabled ? 1 : 0 });
+        }
+        ImGui::SameLine();
+        ImGui::Text("(%zu asleep)", pool.CountAsleep());
+        // 放開滑桿才送出，拖動中不會每幀記錄一筆輸入
+        ImGui::SliderFloat("Threat Cell", &threatCellSize, BallWorld::kMinThreatCellSize, BallWorld::kMaxThreatCellSize);
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            SendInput({ InputType::SetThreatCellSize, threatCellSize, 0 });
+        }
+        ImGui::Checkbox("Show Threat Field", &showThreatField);
+        const ThreatField& threatField = pool.GetThreatField();
+        ImGui::SameLine();
+        ImGui::Text("(%d x %d nodes)", threatField.GetCountX(), threatField.GetCountZ());
+        // 預算以次數計（重播才會一致），換算成毫秒只供參考
+        ImGui::SliderInt("AI Budget", &aiBudget, 0, 256, aiBudget == 0 ? "unlimited" : "%d");
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            SendInput({ InputType::SetAiBudget, 0.0f, aiBudget });
+        }
+        const AiScheduler& aiScheduler = pool.GetAiScheduler();
+        ImGui::Text("AI: %zu due, %zu selected, %zu deferred, %.3f ms",
+                    aiScheduler.GetDueCount(), aiScheduler.GetGrantedCount(), aiScheduler.GetDeferredCount(),
+                    aiScheduler.GetLastMs());
+        ImGui::Text("  %.2f us per selection (budget ~ %.3f ms)", aiScheduler.GetSelectionMs() * 1000.0,
+                    aiScheduler.GetSelectionMs() * aiBudget);
+        // 只有計時器到期的掠食者才會被檢查，其餘的在計時輪裡等
+        ImGui::Text("  %zu selection timers pending", pool.GetSelectionTimers().GetPendingCount());
+        if (ImGui::SliderInt("Worker Threads", &workerThreads, 1, maxWorkerThreads)) {
+            simulation.SetThreadCount(workerThreads);
+        }
+        ImGui::Text("Steps this frame: %d (dropped %.2f s)", stepsThisFrame, fixedTimestep.GetDroppedTime());
+        ImGui::Text("SIMD kernels: %s", Simd::Name(Simd::GetLevel()));
+
+        // 輸入錄製
+        ImGui::Separator();
+        ImGui::Text("Input Recording");
+        ImGui::InputText("File", recordingPath, sizeof(recordingPath));
+        if (!inputRecorder.IsOpen()) {
+            if (ImGui::Button("Start Recording")) {
+                // 以新種子從頭開始，錄製檔才有可重播的起點
+                uint64_t seed = static_cast<uint64_t>(time(nullptr));
+                RecordingHeader header = { seed, currentBalls, simulation.GetGravity(), simulation.GetPredatorSpeed(),
+                                           simulation.GetContinuousCollision(), simulation.GetSleeping(),
+                                           simulation.GetThreatCellSize(), simulation.GetAiBudget(),
+                                           simulation.GetAiFocus() };
+                if (inputRecorder.Open(recordingPath, header)) {
+                    simulation.Restart(seed, currentBalls);
+                    rewindBuffer.Clear();
+                    rewindBuffer.Capture(simulation);
                 } else {
-                    // 重設一般球的速度
-                    float speed = 0.0f;
-                    if (ball->GetPoint() == 15) speed = 4.0f;      // 紅球
-                    else if (ball->GetPoint() == 10) speed = 3.0f; // 橙球
-                    else if (ball->GetPoint() == 5) speed = 2.0f;  // 黃球
-                    
-                    float randomX = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * speed;
-                    float randomZ = (static_cast<float>(rand()) / RAND_MAX * 2.0f - 1.0f) * speed;
-                    ball->SetVelocity(glm::vec3(randomX, 0.0f, randomZ));
+                    printf("Failed to open recording file: %s\n", recordingPath);
                 }
             }
+        } else {
+            if (ImGui::Button("Stop Recording")) {
+                inputRecorder.Close();
+            }
+            ImGui::SameLine();
+            ImGui::Text("%u ticks, %.1f KB", inputRecorder.GetTickCount(), inputRecorder.GetBytesWritten() / 1024.0);
+        }
+
+        // 世界快照
+        ImGui::Separator();
+        ImGui::Text("World Snapshot");
+        ImGui::InputText("Snapshot", snapshotPath, sizeof(snapshotPath));
+        if (ImGui::Button("Save Snapshot")) {
+            if (!WorldSnapshot::Save(snapshotPath, simulation)) {
+                printf("Failed to save snapshot: %s\n", snapshotPath);
+            }
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Load Snapshot")) {
+            if (WorldSnapshot::Load(snapshotPath, simulation)) {
+                // 錄製檔無法從快照重播，載入即停止錄製；控制項跟著快照的設定
+                inputRecorder.Close();
+                SyncControls();
+                rewindBuffer.Clear();
+                rewindBuffer.Capture(simulation);
+            } else {
+                printf("Failed to load snapshot: %s\n", snapshotPath);
+            }
+        }
+
+        // 倒帶時間軸：拖動即暫停並還原到該 tick，取消暫停後從那裡分岔繼續
+        ImGui::Separator();
+        ImGui::Text("Rewind");
+        ImGui::Checkbox("Paused", &simulationPaused);
+        if (!simulationPaused) {
+            rewindTick = static_cast<int>(rewindBuffer.GetNewestTick());
+        }
+        if (ImGui::SliderInt("Tick", &rewindTick, static_cast<int>(rewindBuffer.GetOldestTick()),
+                             static_cast<int>(rewindBuffer.GetNewestTick()))) {
+            simulationPaused = true;
+            if (rewindBuffer.Restore(static_cast<uint32_t>(rewindTick), simulation)) {
+                // 錄製檔無法表示倒帶，還原即停止錄製
+                inputRecorder.Close();
+                SyncControls();
+            }
+        }
+        ImGui::SliderInt("Budget (MB)", &rewindBudgetMB, 8, 1024);
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            // 調整預算會清掉歷史，放開滑桿才重新配置
+            rewindBuffer.SetBudget(static_cast<size_t>(rewindBudgetMB) << 20);
+            rewindBuffer.Capture(simulation);
         }
+        ImGui::Text("%zu frames (%zu keyframes), %.1f / %d MB", rewindBuffer.GetFrameCount(),
+                    rewindBuffer.GetKeyframeCount(), rewindBuffer.GetUsedBytes() / (1024.0 * 1024.0), rewindBudgetMB);
+        ImGui::Text("Capture %.3f ms (avg %.3f), %.1f KB -> %.1f KB", rewindBuffer.GetLastCaptureMs(),
+                    rewindBuffer.GetAverageCaptureMs(), rewindBuffer.GetLastImageBytes() / 1024.0,
+                    rewindBuffer.GetLastFrameBytes() / 1024.0);
 
         // 顯示分數和AI狀態
         ImGui::Separator();
         ImGui::Text("Scores & AI Status:");
-        for (auto ball : balls) {
-            if (ball->IsPredator()) {
-                glm::vec3 color = ball->GetColor();
+        BallWorld& world = simulation.GetWorld();
+        for (size_t i = 0; i < world.Size(); i++) {
+            DrawBall ball = world.Ball(i);
+            if (ball.IsPredator()) {
+                glm::vec3 color = ball.GetColor();
                 if (color.r > 0.4f && color.g > 0.4f && color.b > 0.4f) {
                     // Gray Predator (FSM)
-                    ImGui::Text("Grey Predator (FSM) Score: %d", ball->GetScore());
-                    std::string stateStr = (ball->GetCurrentState() == FSMState::SelectTarget) ? "SelectTarget" : "ChaseTarget";
-                    ImGui::Text("  State: %s", stateStr.c_str());
-                    if (ball->GetTargetPrey() != nullptr) {
-                        ImGui::Text("  Target: Point %d", ball->GetTargetPrey()->GetPoint());
+                    ImGui::Text("Grey Predator (FSM) Score: %d", ball.GetScore());
+                    // 字串常值，不必每幀建立 std::string
+                    const char* stateName = (ball.GetCurrentState() == FSMState::SelectTarget) ? "SelectTarget" : "ChaseTarget";
+                    ImGui::Text("  State: %s", stateName);
+                    int target = ball.GetTargetPrey();
+                    if (target >= 0) {
+                        ImGui::Text("  Target: Point %d", world.point[target]);
                     } else {
                         ImGui::Text("  Target: None");
                     }
                 } else {
                     // Purple Predator (Fuzzy Logic)
-                    ImGui::Text("Purple Predator (Fuzzy) Score: %d", ball->GetScore());
-                    if (ball->GetTargetPrey() != nullptr) {
-                        ImGui::Text("  Target: Point %d", ball->GetTargetPrey()->GetPoint());
+                    ImGui::Text("Purple Predator (Fuzzy) Score: %d", ball.GetScore());
+                    int target = ball.GetTargetPrey();
+                    if (target >= 0) {
+                        ImGui::Text("  Target: Point %d", world.point[target]);
                     } else {
                         ImGui::Text("  Target: None");
                     }
@@ -576,6 +630,19 @@ int main() {
         ImGui::End();
         #pragma endregion
     
+        // 每幀只上傳一次 instance 資料，兩個視口共用
+        ballRenderer.Upload(world, interpolateRender ? fixedTimestep.GetAlpha() : 1.0f);
+        if (showThreatField) {
+            threatRenderer.Upload(world.GetThreatField());
+        }
+
+        // 相機與光源每幀上傳一次，各視口只切換 UBO 範圍
+        sceneUniforms.SetView(0, viewMat, projMat, camera.Position); // 透視投影
+        sceneUniforms.SetView(1, viewMat2, orthoProjMat, camera2.Position); // 正交投影
+        sceneUniforms.Frame().lightEnabled[0] = light1Enabled;
+        sceneUniforms.Frame().lightEnabled[1] = light2Enabled;
+        sceneUniforms.Upload();
+
         // 啟用剪裁測試
         glEnable(GL_SCISSOR_TEST);
 
@@ -583,28 +650,21 @@ int main() {
         glViewport(0, 600, 800, 600);
         glScissor(0, 600, 800, 600);
         glClear(GL_DEPTH_BUFFER_BIT);
+        sceneUniforms.BindView(0);
         #pragma region Create room
         modelMat = glm::mat4(1.0f);
 
         myShader->use();
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, TexBufferA);
-        glUniform1i(glGetUniformLocation(myShader->ID, "roomTex"), 0);
-        glUniform1i(glGetUniformLocation(myShader->ID, "isRoom"), 1);
-        glUniform1i(glGetUniformLocation(myShader->ID, "isbox"), 0);
-        glUniformMatrix4fv(glGetUniformLocation(myShader->ID, "modelMat"), 1, GL_FALSE, glm::value_ptr(modelMat));
-        glUniformMatrix4fv(glGetUniformLocation(myShader->ID, "viewMat"), 1, GL_FALSE, glm::value_ptr(viewMat));
-        glUniformMatrix4fv(glGetUniformLocation(myShader->ID, "projMat"), 1, GL_FALSE, glm::value_ptr(projMat)); // 透視投影
-
-        glUniform3f(glGetUniformLocation(myShader->ID, "objColor"), 0.5f, 0.5f, 0.5f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "ambientColor"), 1.0f, 1.0f, 1.0f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "lightPos"), 0.0f, 0.0f, 0.0f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "lightColor"), 0.5f, 0.5f, 0.5f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "lightPos2"), 0.0f, 0.0f, 0.0f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "lightColor2"), 0.2f, 0.7f, 0.9f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "cameraPos"), camera.Position.x, camera.Position.y, camera.Position.z);
-        glUniform1i(glGetUniformLocation(myShader->ID, "light1Enabled"), light1Enabled);
-        glUniform1i(glGetUniformLocation(myShader->ID, "light2Enabled"), light2Enabled);
+        myShader->SetInt(roomUniforms.roomTex, 0);
+        myShader->SetBool(roomUniforms.isRoom, true);
+        myShader->SetBool(roomUniforms.isbox, false);
+        myShader->SetBool(roomUniforms.isInstanced, false);
+        myShader->SetMat4(roomUniforms.modelMat, modelMat);
+
+        myShader->SetVec3(roomUniforms.objColor, 0.5f, 0.5f, 0.5f);
+        threatRenderer.Apply(showThreatField);
 
         glBindVertexArray(roomVAO);
         glDrawArrays(GL_TRIANGLES, 0, 36);
@@ -612,36 +672,27 @@ int main() {
 
         
 
-        for (auto ball : balls) {
-            ball->Render(myShader, viewMat, projMat, camera.Position);
-        }
+        ballRenderer.Draw();
 
         // 視口 2：右上（頂視圖，使用正交投影）
         glViewport(800, 600, 800, 600);
         glScissor(800, 600, 800, 600);
         glClear(GL_DEPTH_BUFFER_BIT);
+        sceneUniforms.BindView(1);
         #pragma region Create room
         modelMat = glm::mat4(1.0f);
 
         myShader->use();
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, TexBufferA);
-        glUniform1i(glGetUniformLocation(myShader->ID, "roomTex"), 0);
-        glUniform1i(glGetUniformLocation(myShader->ID, "isRoom"), 1);
-        glUniform1i(glGetUniformLocation(myShader->ID, "isbox"), 0);
-        glUniformMatrix4fv(glGetUniformLocation(myShader->ID, "modelMat"), 1, GL_FALSE, glm::value_ptr(modelMat));
-        glUniformMatrix4fv(glGetUniformLocation(myShader->ID, "viewMat"), 1, GL_FALSE, glm::value_ptr(viewMat2));
-        glUniformMatrix4fv(glGetUniformLocation(myShader->ID, "projMat"), 1, GL_FALSE, glm::value_ptr(orthoProjMat)); // 正交投影
-
-        glUniform3f(glGetUniformLocation(myShader->ID, "objColor"), 0.5f, 0.5f, 0.5f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "ambientColor"), 1.0f, 1.0f, 1.0f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "lightPos"), 0.0f, 0.0f, 0.0f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "lightColor"), 0.5f, 0.5f, 0.5f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "lightPos2"), 0.0f, 0.0f, 0.0f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "lightColor2"), 0.2f, 0.7f, 0.9f);
-        glUniform3f(glGetUniformLocation(myShader->ID, "cameraPos"), camera2.Position.x, camera2.Position.y, camera2.Position.z);
-        glUniform1i(glGetUniformLocation(myShader->ID, "light1Enabled"), light1Enabled);
-        glUniform1i(glGetUniformLocation(myShader->ID, "light2Enabled"), light2Enabled);
+        myShader->SetInt(roomUniforms.roomTex, 0);
+        myShader->SetBool(roomUniforms.isRoom, true);
+        myShader->SetBool(roomUniforms.isbox, false);
+        myShader->SetBool(roomUniforms.isInstanced, false);
+        myShader->SetMat4(roomUniforms.modelMat, modelMat);
+
+        myShader->SetVec3(roomUniforms.objColor, 0.5f, 0.5f, 0.5f);
+        threatRenderer.Apply(showThreatField);
 
         glBindVertexArray(roomVAO);
         glDrawArrays(GL_TRIANGLES, 0, 36);
@@ -649,83 +700,11 @@ int main() {
 
         
 
-        for (auto ball : balls) {
-            ball->Render(myShader, viewMat2, orthoProjMat, camera2.Position);
-        }
+        ballRenderer.Draw();
 
         // 禁用剪裁測試
         glDisable(GL_SCISSOR_TEST);
 
-        // 收集掠食者和獵物的列表
-        std::vector<DrawBall*> predators;
-        std::vector<DrawBall*> preys;
-        for (auto ball : balls) {
-            if (ball->IsPredator()) {
-                predators.push_back(ball);
-            } else {
-                preys.push_back(ball);
-            }
-        }
-        
-        for (auto ball : balls) {
-            ball->Update(deltaTime, roomAABB, balls);
-        }
-            
-            // 碰撞檢測和處理
-            std::vector<DrawBall*> ballsToRemove;
-            
-            for (size_t i = 0; i < balls.size(); i++) {
-                for (size_t j = i + 1; j < balls.size(); j++) {
-                    glm::vec3 pos1 = balls[i]->GetPosition();
-                    glm::vec3 pos2 = balls[j]->GetPosition();
-                    float radius1 = balls[i]->GetScale();
-                    float radius2 = balls[j]->GetScale();
-                    
-                    if (AABB::SphereToSphere(pos1, radius1, pos2, radius2)) {
-                        // 檢查是否為掠食者與一般球的碰撞
-                        bool isPredatorPreyCollision = false;
-                        DrawBall* predator = nullptr;
-                        DrawBall* prey = nullptr;
-                        
-                        if (balls[i]->IsPredator() && !balls[j]->IsPredator()) {
-                            predator = balls[i];
-                            prey = balls[j];
-                            isPredatorPreyCollision = true;
-                        } else if (!balls[i]->IsPredator() && balls[j]->IsPredator()) {
-                            predator = balls[j];
-                            prey = balls[i];
-                            isPredatorPreyCollision = true;
-                        }
-                        
-                        if (isPredatorPreyCollision) {
-                            // 掠食者吃掉獵物
-                            predator->SetScore(predator->GetScore() + prey->GetPoint());
-                            // 標記要移除的球
-                            if (std::find(ballsToRemove.begin(), ballsToRemove.end(), prey) == ballsToRemove.end()) {
-                                ballsToRemove.push_back(prey);
-                            }
-                        } else {
-                            // 一般的球與球碰撞
-                            ResolveSphereCollision(balls[i], balls[j]);
-                        }
-                    }
-                }
-            }
-            
-            // 移除被吃掉的球
-            for (auto ballToRemove : ballsToRemove) {
-                auto it = std::find(balls.begin(), balls.end(), ballToRemove);
-                if (it != balls.end()) {
-                    delete *it;
-                    balls.erase(it);
-                }
-            }
-        
-        // 渲染所有球
-        for (auto ball : balls) {
-            ball->Render(myShader, viewMat, projMat, camera.Position);
-        }
-
         // 檢查 OpenGL 錯誤
         GLenum err;
         while ((err = glGetError()) != GL_NO_ERROR) {
@@ -742,10 +721,9 @@ int main() {
     }
 
     // 清理
-    for (auto ball : balls) {
-        delete ball;
-    }
-    balls.clear();
+    ballRenderer.Release();
+    threatRenderer.Release();
+    sceneUniforms.Release();
 
     //Exit program
     ImGui_ImplOpenGL3_Shutdown();
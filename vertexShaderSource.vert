@@ -3,23 +3,40 @@ layout (location = 6) in vec3 aPos;
 layout (location = 7) in vec3 aColor;
 layout (location = 8) in vec2 aTexCoord;
 layout (location = 9) in vec3 aNormal;
+// per-instance (balls only): position.xyz + uniform scale, colour
+layout (location = 10) in vec4 aInstancePosScale;
+layout (location = 11) in vec3 aInstanceColor;
 
 
 out vec2 TexCoord;
 
 out vec3 Normal;
 out vec3 FragPos;
+out vec3 InstanceColor;
+
+// per viewport, see SceneUniformBuffer
+layout (std140) uniform ViewData {
+    mat4 viewMat;
+    mat4 projMat;
+    vec4 cameraPos;
+};
 
 uniform mat4 modelMat;
-uniform mat4 viewMat;
-uniform mat4 projMat;
+uniform bool isInstanced;
 
 void main() {
-    gl_Position =  projMat * viewMat * modelMat * vec4(aPos.xyz, 1.0);
-    
-    
 	TexCoord = aTexCoord;
 
-    FragPos = (modelMat * vec4(aPos.xyz, 1.0)).xyz;
-    Normal = mat3(transpose(inverse(modelMat))) * aNormal;
+    if (isInstanced) {
+        // translate + uniform scale: the normal matrix is the identity up to scale
+        FragPos = aPos.xyz * aInstancePosScale.w + aInstancePosScale.xyz;
+        Normal = aNormal;
+        InstanceColor = aInstanceColor;
+    } else {
+        FragPos = (modelMat * vec4(aPos.xyz, 1.0)).xyz;
+        Normal = mat3(transpose(inverse(modelMat))) * aNormal;
+        InstanceColor = vec3(0.0);
+    }
+
+    gl_Position = projMat * viewMat * vec4(FragPos, 1.0);
 }
\ No newline at end of file